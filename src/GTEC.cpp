@@ -37,6 +37,113 @@
 #include "inout.hpp"
 #include "ObsData.hpp"
 #include "solver.hpp"
+#include "obsStream.hpp"
+#include <algorithm>
+
+
+
+//Real-time mode, follows observation file being written and preprocesses arcs as they close.
+//At each sampling time boundary, system is rebuilt over sampling blocks touched by new arcs.
+static int streamCalibration(inout& io, long long windowStart, long long windowEnd)
+{
+    navigation navdata(io.navfiles);
+    navdata.read();
+
+    ObsData obs(std::vector<std::string>(1, io.streamFile), io.satSys);
+    obs.setEpochFilter(windowStart, windowEnd, io.decimation, io.decimationOffset);
+    obs.setSmoothing(io.sgHalfWindow, io.sgOrder);
+    obs.setHatchFilter(io.hatchWindow);
+    obsStream stream(obs, io.streamFile, io.streamIdle);
+
+    std::cout << "waiting for observation header..\n";
+    while(!stream.headerRead && !stream.finished)
+    {
+        stream.poll(1000);
+    }
+    if(!stream.headerRead)
+    {
+        std::cout << "Observation stream ended without header: " << io.streamFile << "\n";
+        exit(-1);
+    }
+
+    double igrfEpoch = io.year + (io.firstDayOfYear - 1 + 0.5 * io.numDays) / 365.25;
+    igrf igrfModel(igrfEpoch, io.inputDirectory, io.rh);
+    igrfModel.buildTile(obs.MarkerEllipsoidal);
+
+    solver sys(obs, navdata, io, igrfModel);
+
+    std::vector<long long>& t = obs.timeline_main;
+    long long block = io.samplingTime * 60 * internalTime::NANO;
+    long long boundary = 0; //next sampling time boundary
+    int dirtyFrom = -1;     //epochs of arcs closed since last solution
+    int dirtyTo = -1;
+    int first, last;
+
+    std::cout << "streaming observations..\n";
+    while(true)
+    {
+        stream.poll(1000);
+        if(t.size() < 2)
+        {
+            if(stream.finished)
+                break;
+            continue;
+        }
+        if(boundary == 0)
+        {
+            boundary = (t[0] / block + 1) * block;
+        }
+
+        if(obs.processClosedArcs(navdata, io.rh, io.minArcLen, io.intrpolIntrvl, io.deg,
+                                 io.minElevation, io.maxElevation, first, last, stream.finished) > 0)
+        {
+            if(io.codeLevelling)
+            {
+                obs.levelArcs();
+            }
+            if(!io.qualityFile.empty() && !obs.writeArcQuality(io.qualityFile))
+            {
+                std::cout << "Unable to write arc quality file " << io.qualityFile << "\n";
+            }
+            if(!io.rotiFile.empty())
+            {
+                obs.computeROTI(io.rotiWindow);
+                if(!obs.writeROTI(io.rotiFile))
+                {
+                    std::cout << "Unable to write ROTI file " << io.rotiFile << "\n";
+                }
+            }
+            dirtyFrom = (dirtyFrom < 0 || first < dirtyFrom) ? first : dirtyFrom;
+            dirtyTo = (last > dirtyTo) ? last : dirtyTo;
+        }
+
+        //all epochs before closedUpTo are complete
+        long long closedUpTo = stream.finished ? t.back() + obs.interval : t.back();
+        while(closedUpTo >= boundary)
+        {
+            int end = std::lower_bound(t.begin(), t.end(), boundary) - t.begin();
+            if(dirtyFrom >= 0 && dirtyFrom < end)
+            {
+                long long blockStart = (t[dirtyFrom] / block) * block;
+                int begin = std::lower_bound(t.begin(), t.end(), blockStart) - t.begin();
+                sys.solveEpochs(begin, end);
+                std::cout << "Solved up to " << boundary / internalTime::NANO << " (GPST): Size of S: " 
+                          << sys.S.size() << " Number of Arcs: " << obs.numArcs << "\n";
+
+                //arcs reaching further blocks are solved again with them
+                dirtyFrom = (dirtyTo >= end) ? end : -1;
+                dirtyTo = (dirtyTo >= end) ? dirtyTo : -1;
+            }
+            boundary += block;
+        }
+
+        if(stream.finished)
+            break;
+    }
+
+    sys.cleanUp();
+    return 0;
+}
 
 
 
@@ -49,7 +156,22 @@ int main(int argc, char* argv[])
 
     int samplingtime = 10; //in Minutes
     
+    int rejHours = io.marginHours; //Number of hours to reject from start and end
+    int arcHours = io.minSolutionArc; //Duration of arc in hours
+
+    //Only epochs of processed days and margin around them are read
+    long long dayStart = (internalTime::daysFromCivil(io.year, 1, 1) + io.firstDayOfYear - 1) * 86400LL;
+    long long dayEnd = dayStart + io.numDays * 86400LL;
+
+    if(!io.streamFile.empty())
+    {
+        return streamCalibration(io, dayStart - rejHours * 3600, dayEnd + rejHours * 3600);
+    }
+
     ObsData obs(io.obsfiles,io.satSys);
+    obs.setEpochFilter(dayStart - rejHours * 3600, dayEnd + rejHours * 3600, io.decimation, io.decimationOffset);
+    obs.setSmoothing(io.sgHalfWindow, io.sgOrder);
+    obs.setHatchFilter(io.hatchWindow);
     obs.read();
     
     navigation navdata(io.navfiles);
@@ -58,17 +180,37 @@ int main(int argc, char* argv[])
     std::cout << "done reading all files..\n\n";
 
     
+    std::cout << "computing elevations..\n";
+    obs.setElevations(navdata, io.rh);
+    
     std::cout << "preprocessing..\n";
-    obs.pre_process(io.minArcLen,io.intrpolIntrvl,io.deg);
+    obs.pre_process(io.minArcLen,io.intrpolIntrvl,io.deg,io.minElevation,io.maxElevation);
+    if(io.codeLevelling)
+    {
+        obs.levelArcs();
+    }
+    if(!io.qualityFile.empty() && !obs.writeArcQuality(io.qualityFile))
+    {
+        std::cout << "Unable to write arc quality file " << io.qualityFile << "\n";
+    }
+    if(!io.rotiFile.empty())
+    {
+        obs.computeROTI(io.rotiWindow);
+        if(!obs.writeROTI(io.rotiFile))
+        {
+            std::cout << "Unable to write ROTI file " << io.rotiFile << "\n";
+        }
+    }
 
-    int rejHours = 12; //Number of hours to reject from start and end
-    int arcHours = 2; //Duration of arc in hours
     obs.markArcStartEnd(rejHours, arcHours);
     std::cout << "done preprocessing..\n\n";
 
 
     //Create IGRF object
-    igrf igrfModel(io.year, io.inputDirectory);
+    //at middle of processed days
+    double igrfEpoch = io.year + (io.firstDayOfYear - 1 + 0.5 * io.numDays) / 365.25;
+    igrf igrfModel(igrfEpoch, io.inputDirectory, io.rh);
+    igrfModel.buildTile(obs.MarkerEllipsoidal);
 
     //Create solver object
     solver sys(obs, navdata, io, igrfModel);
@@ -34,7 +34,17 @@
 #include <exception>
 #include <algorithm>
 #include "ObsData.hpp"
+#include "navigation.hpp"
+#include "geometry.hpp"
 #include "constants.hpp"
+#include "fieldParser.hpp"
+#include <cmath>
+#include <limits>
+#include <atomic>
+#include <thread>
+#include <cstdint>
+#include <cstdio>
+#include <unistd.h>
 
 void ObsData::setSysFlags(std::string sysString)
 {
@@ -61,6 +71,11 @@ ObsData::ObsData(std::vector<std::string> fvec, std::string sysString)
     setSysFlags(sysString);
 
     timeline_main = {};
+    interval = 0;
+    windowStart = std::numeric_limits<long long>::min();
+    windowEnd = std::numeric_limits<long long>::max();
+    decimation = 0;
+    decimationOffset = 0;
     if(readGPS)
         {
             GPS_ucTEC = { {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {} };
@@ -100,7 +115,17 @@ ObsData::ObsData(std::vector<std::string> fvec, std::string sysString)
     for(int i = 0; i < 120; ++i)
         {
             NonZero_Mark[i] = 0;
+            streamFrom[i] = 0;
         }
+    code1.assign(120, std::vector<double>());
+    code2.assign(120, std::vector<double>());
+    wideLane.assign(120, std::vector<double>());
+    lossOfLock.assign(120, std::vector<unsigned char>());
+    validEpochs.assign(120, epochMask());
+    elevationEpochs = 0;
+    rotiWindow = 0;
+    hatchWindow = 0;
+    codeTEC.assign(120, std::vector<float>());
 
     numNonZeroArcs = 0;
     
@@ -115,22 +140,75 @@ void ObsData::resetMark()
                 GPS_Mark[i] = 0;
             }
     if(readGLO)
-        for(int i = 0; i < GPS_SIZE; ++i)
+        for(int i = 0; i < GLO_SIZE; ++i)
             {
                 GLO_Mark[i] = 0;
             }
     if(readGAL)
-        for(int i = 0; i < GPS_SIZE; ++i)
+        for(int i = 0; i < GAL_SIZE; ++i)
             {
                 GAL_Mark[i] = 0;
             }
     if(readBEI)
-        for(int i = 0; i < GPS_SIZE; ++i)
+        for(int i = 0; i < BDU_SIZE; ++i)
             {
                 BDU_Mark[i] = 0;
             }
 };
 
+void ObsData::setEpochFilter(long long start, long long end, int decimationSeconds, int offsetSeconds)
+{
+    windowStart = start * internalTime::NANO;
+    windowEnd = end * internalTime::NANO;
+    decimation = decimationSeconds * internalTime::NANO;
+    decimationOffset = offsetSeconds * internalTime::NANO;
+};
+
+bool ObsData::keepEpoch(long long t)
+{
+    if(t < windowStart || t >= windowEnd)
+        return false;
+    if(decimation == 0)
+        return true;
+    //remainder is taken non negative, for epochs before 1970
+    long long rem = (t - decimationOffset) % decimation;
+    return (rem < 0 ? rem + decimation : rem) == 0;
+};
+
+void ObsData::setSmoothing(int halfWindow, int order)
+{
+    outlierFilter = savitzkyGolay(halfWindow, order);
+};
+
+void ObsData::setHatchFilter(int windowSeconds)
+{
+    hatchWindow = windowSeconds;
+};
+
+void ObsData::pushObservables(int index, double C1, double C2, double L1, double L2, int lli)
+{
+    code1[index].push_back(C1);
+    code2[index].push_back(C2);
+    wideLane[index].push_back(L1 - L2);
+    lossOfLock[index].push_back((lli >= 0 && lli <= 7) ? lli : 0);
+    //blank phase fields are read as 0, TEC of this epoch is not usable
+    validEpochs[index].push(L1 != 0.0 && L2 != 0.0);
+};
+
+void ObsData::padObservables(int index)
+{
+    code1[index].push_back(0.0);
+    code2[index].push_back(0.0);
+    wideLane[index].push_back(0.0);
+    lossOfLock[index].push_back(0);
+    validEpochs[index].push(false);
+};
+
+void ObsData::closeEpoch()
+{
+    pad_zero();
+};
+
 int ObsData::pad_zero()
 {
     if(readGPS && hasGPS)
@@ -140,6 +218,7 @@ int ObsData::pad_zero()
                     if(GPS_Mark[i] == 0)
                         {
                             GPS_ucTEC[i].push_back(0);
+                            padObservables(i);
                         }
                 }
         }
@@ -150,6 +229,7 @@ int ObsData::pad_zero()
                     if(GLO_Mark[i] == 0)
                         {
                             GLO_ucTEC[i].push_back(0);
+                            padObservables(GPS_SIZE + i);
                         }
                 }
         }
@@ -160,6 +240,7 @@ int ObsData::pad_zero()
                     if(GAL_Mark[i] == 0)
                         {
                             GAL_ucTEC[i].push_back(0);
+                            padObservables(GPS_SIZE + GLO_SIZE + i);
                         }
                 }
         }
@@ -170,6 +251,7 @@ int ObsData::pad_zero()
                     if(BDU_Mark[i] == 0)
                         {
                             BDU_ucTEC[i].push_back(0);
+                            padObservables(GPS_SIZE + GLO_SIZE + GAL_SIZE + i);
                         }
                 }
         }
@@ -183,345 +265,315 @@ void ObsData::read()
         {
             std::ifstream inputFile;
             inputFile.open(fname);
-
-            std::string line;
-            std::string str;
-            std::string tmp;
-            std::size_t pos;
-            internalTime epoch_time;
             int lineNumber = 0;
 
-            if(inputFile.is_open())
+            if(!inputFile.is_open())
                 {
-                    while(std::getline(inputFile, line))
-                        {
-                            lineNumber += 1;
-                            str = line.substr(60);
-                            if(str[0] == 'E' && str[1] == 'N' && str[2] == 'D' && str[4] == 'O' && str[5] == 'F' && str[7] == 'H' &&
-                               str[8] == 'E' && str[9] == 'A' && str[10] == 'D' && str[11] == 'E' && str[12] == 'R')
-                                {
-                                    std::cout << "End of Header !!"
-                                              << "\n";
-                                    break;
-                                }
+                    std::cout << "Unable to open observation file: " << fname << "\n";
+                    std::cout << "Exiting with non-zero status !\n";
+                    exit(-1);
+                }
 
-                            if(str[0] == 'R' && str[1] == 'I' && str[2] == 'N' && str[3] == 'E' && str[4] == 'X')
-                                version = stof(line);
+            readHeader(inputFile, lineNumber);
 
-                            if(str[0] == 'I' && str[1] == 'N' && str[2] == 'T' && str[3] == 'E' && str[4] == 'R' && str[5] == 'V' &&
-                               str[6] == 'A' && str[7] == 'L')
-                                interval = stoi(line);
+            // Now read data portion
+            int epoch_counter = 0;
+            bool skipEpoch = false;
+            readRecords(inputFile, fname, lineNumber, epoch_counter, skipEpoch);
 
-                            if(str[0] == 'A' && str[1] == 'P' && str[2] == 'P' && str[3] == 'R' && str[4] == 'O' && str[5] == 'X')
-                                {
-                                    MarkerPosition.X = stof(line, &pos);
-                                    tmp = line.substr(pos);
-                                    MarkerPosition.Y = stof(tmp, &pos);
-                                    tmp = tmp.substr(pos);
-                                    MarkerPosition.Z = stof(tmp);
-                                }
+            // Now pad zero for the last epoch
+            if(epoch_counter != 0 && !skipEpoch)
+                {
+                    pad_zero();
+                }
 
-                            if(str[0] == 'T' && str[1] == 'I' && str[2] == 'M' && str[3] == 'E' && str[8] == 'F' && str[9] == 'I' &&
-                               str[10] == 'R' && str[11] == 'S' && str[12] == 'T')
-                                {
+            // Closing Input file
+            inputFile.close();
+        }
 
-                                    TOFO.parse(line, tmp);
-                                    TOFO.toUNIXTime();
-                                    // Now Get system in which this time is represented
-                                    pos = 0;
-                                    while(isspace(tmp[pos]))
-                                        {
-                                            pos += 1;
-                                        }
-                                    TOFO_system = tmp.substr(pos, 3);
-                                    hasTOFO = true;
-                                }
+    if(!setInterval())
+        {
+            std::cout << "Unable to determine observation interval.\n";
+            std::cout << "Exiting with non-zero status !\n";
+            exit(-1);
+        }
 
-                            if(line[0] == 'G' && str[0] == 'S' && str[1] == 'Y' && str[2] == 'S' && str[10] == 'O' &&
-                               str[11] == 'B' && str[12] == 'S')
-                                hasGPS = true;
-                            if(line[0] == 'R' && str[0] == 'S' && str[1] == 'Y' && str[2] == 'S' && str[10] == 'O' &&
-                               str[11] == 'B' && str[12] == 'S')
-                                hasGLO = true;
-                            if(line[0] == 'E' && str[0] == 'S' && str[1] == 'Y' && str[2] == 'S' && str[10] == 'O' &&
-                               str[11] == 'B' && str[12] == 'S')
-                                hasGAL = true;
-                            if(line[0] == 'C' && str[0] == 'S' && str[1] == 'Y' && str[2] == 'S' && str[10] == 'O' &&
-                               str[11] == 'B' && str[12] == 'S')
-                                hasBEI = true;
-                        }
+    // Now set Non zero arc markings
+    getnumNonZeroArcs();
+};
+
+bool ObsData::readHeader(std::istream& inputFile, int& lineNumber)
+{
+    std::string line;
+    std::string str;
+    std::string tmp;
+    std::size_t pos;
+
+    while(std::getline(inputFile, line))
+        {
+            lineNumber += 1;
+            str = line.substr(60);
+            if(str[0] == 'E' && str[1] == 'N' && str[2] == 'D' && str[4] == 'O' && str[5] == 'F' && str[7] == 'H' &&
+               str[8] == 'E' && str[9] == 'A' && str[10] == 'D' && str[11] == 'E' && str[12] == 'R')
+                {
+                    std::cout << "End of Header !!"
+                              << "\n";
+                    // Station position is constant, convert it once
+                    navigation::ecefToEllipsoidal(MarkerPosition, MarkerEllipsoidal);
+                    return true;
                 }
-            else
+
+            if(str[0] == 'R' && str[1] == 'I' && str[2] == 'N' && str[3] == 'E' && str[4] == 'X')
+                version = stof(line);
+
+            if(str[0] == 'I' && str[1] == 'N' && str[2] == 'T' && str[3] == 'E' && str[4] == 'R' && str[5] == 'V' &&
+               str[6] == 'A' && str[7] == 'L')
+                interval = llround(stod(line) * internalTime::NANO);
+
+            if(str[0] == 'A' && str[1] == 'P' && str[2] == 'P' && str[3] == 'R' && str[4] == 'O' && str[5] == 'X')
                 {
-                    std::cout << "Unable to open observation file: " << fname << "\n";
-                    std::cout << "Exiting with non-zero status !\n";
-                    exit(-1);
+                    MarkerPosition.X = stof(line, &pos);
+                    tmp = line.substr(pos);
+                    MarkerPosition.Y = stof(tmp, &pos);
+                    tmp = tmp.substr(pos);
+                    MarkerPosition.Z = stof(tmp);
                 }
 
-            // Now read data portion
-            int epoch_counter = 0;
-            float C1, C2, L1, L2;
-            int lli;
-            int SatID;
+            if(str[0] == 'T' && str[1] == 'I' && str[2] == 'M' && str[3] == 'E' && str[8] == 'F' && str[9] == 'I' &&
+               str[10] == 'R' && str[11] == 'S' && str[12] == 'T')
+                {
 
-            float GPS_f12 = (1.0 / (GPS_f2 * GPS_f2)) - (1.0 / (GPS_f1 * GPS_f1));
-            float GLO_f12 = (1.0 / (GLO_f2 * GLO_f2)) - (1.0 / (GLO_f1 * GLO_f1));
-            float GAL_f12 = (1.0 / (GAL_f2 * GAL_f2)) - (1.0 / (GAL_f1 * GAL_f1));
-            float BDU_f12 = (1.0 / (BDU_f2 * BDU_f2)) - (1.0 / (BDU_f1 * BDU_f1));
+                    TOFO.parse(line, tmp);
+                    TOFO.toUNIXTime();
+                    // Now Get system in which this time is represented
+                    pos = 0;
+                    while(isspace(tmp[pos]))
+                        {
+                            pos += 1;
+                        }
+                    TOFO_system = tmp.substr(pos, 3);
+                    hasTOFO = true;
+                }
 
-            float GPS_tau = 1.0 / (40.3 * GPS_f12);
-            float GLO_tau = 1.0 / (40.3 * GLO_f12);
-            float GAL_tau = 1.0 / (40.3 * GAL_f12);
-            float BDU_tau = 1.0 / (40.3 * BDU_f12);
+            if(line[0] == 'G' && str[0] == 'S' && str[1] == 'Y' && str[2] == 'S' && str[10] == 'O' &&
+               str[11] == 'B' && str[12] == 'S')
+                hasGPS = true;
+            if(line[0] == 'R' && str[0] == 'S' && str[1] == 'Y' && str[2] == 'S' && str[10] == 'O' &&
+               str[11] == 'B' && str[12] == 'S')
+                hasGLO = true;
+            if(line[0] == 'E' && str[0] == 'S' && str[1] == 'Y' && str[2] == 'S' && str[10] == 'O' &&
+               str[11] == 'B' && str[12] == 'S')
+                hasGAL = true;
+            if(line[0] == 'C' && str[0] == 'S' && str[1] == 'Y' && str[2] == 'S' && str[10] == 'O' &&
+               str[11] == 'B' && str[12] == 'S')
+                hasBEI = true;
+        }
+    return false;
+};
 
-            while(!inputFile.eof())
+bool ObsData::readObservables(const std::string& line, double& C1, double& L1, double& C2, double& L2, int& lliL1)
+{
+    //satellite id takes 3 columns, then each observable F14.3 value, I1 LLI and I1 SSI (16 columns),
+    //so LLI and SSI digits are never taken as part of value or as separate fields
+    const char* p = line.data();
+    int len = line.size();
+    return fieldParser::toDouble(p, len, 3, 14, C1) &&
+           fieldParser::toDouble(p, len, 3 + 16, 14, L1) &&
+           fieldParser::toInt(p, len, 3 + 16 + 14, 1, lliL1) &&
+           fieldParser::toDouble(p, len, 3 + 3 * 16, 14, C2) &&
+           fieldParser::toDouble(p, len, 3 + 4 * 16, 14, L2);
+};
+
+void ObsData::readRecords(std::istream& inputFile, const std::string& fname, int& lineNumber, int& epoch_counter, bool& skipEpoch)
+{
+    std::string line;
+    std::string tmp;
+    std::size_t pos;
+    internalTime epoch_time;
+
+    // phase counts are ~1e8 cycles, kept in double precision
+    double C1, C2, L1, L2;
+    int lliL1;
+    int SatID;
+
+    float GPS_f12 = (1.0 / (GPS_f2 * GPS_f2)) - (1.0 / (GPS_f1 * GPS_f1));
+    float GLO_f12 = (1.0 / (GLO_f2 * GLO_f2)) - (1.0 / (GLO_f1 * GLO_f1));
+    float GAL_f12 = (1.0 / (GAL_f2 * GAL_f2)) - (1.0 / (GAL_f1 * GAL_f1));
+    float BDU_f12 = (1.0 / (BDU_f2 * BDU_f2)) - (1.0 / (BDU_f1 * BDU_f1));
+
+    float GPS_tau = 1.0 / (40.3 * GPS_f12);
+    float GLO_tau = 1.0 / (40.3 * GLO_f12);
+    float GAL_tau = 1.0 / (40.3 * GAL_f12);
+    float BDU_tau = 1.0 / (40.3 * BDU_f12);
+
+    while(!inputFile.eof())
+        {
+            std::getline(inputFile, line);
+            lineNumber += 1;
+
+            // check for blank lines
+            if(line.size() == 0)
+                {
+                    continue;
+                }
+
+            if(line[0] == '>')
                 {
-                    std::getline(inputFile, line);
-                    lineNumber += 1;
+                    // Epoch started, fill zeros for previous epoch
+                    // (unless it was skipped, in which case it is already done)
+                    if(epoch_counter != 0 && !skipEpoch)
+                        {
+                            pad_zero();
+                        }
 
-                    // check for blank lines
-                    if(line.size() == 0)
+                    // read convert and push time in timeline
+                    // std::cout << line << "\t";
+                    if(!epoch_time.parseEpoch(line.data(), line.size()))
                         {
+                            // not in fixed columns, parse separated fields
+                            epoch_time.parse(line);
+                        }
+                    epoch_time.toUNIXTime();
+                    // timeline is kept in GPS time
+                    if(TOFO_system == "GLO")
+                        {
+                            epoch_time.UNIX = internalTime::utcToGPST(epoch_time.UNIX);
+                        }
+                    else if(TOFO_system == "BDT")
+                        {
+                            epoch_time.UNIX = internalTime::bdtToGPST(epoch_time.UNIX);
+                        }
+                    // skip epochs out of time window or decimation, with all their satellite lines
+                    skipEpoch = !keepEpoch(epoch_time.UNIXNano());
+                    if(skipEpoch)
+                        {
+                            // epochs are in time order, nothing after window end is kept
+                            if(epoch_time.UNIXNano() >= windowEnd)
+                                return;
                             continue;
                         }
+                    // Now increment Epoch Counter
+                    epoch_counter += 1;
+                    timeline_main.push_back(epoch_time.UNIXNano());
+                }
+            else if(!skipEpoch)
+                {
+                    if(line[0] == 'G' && readGPS)
+                        {
+                            // Processing GPS Line...
+                            if(line.size() < 85)
+                                {
+                                    continue;
+                                }
+
+                            tmp = line.substr(1);
+                            SatID = stoi(tmp, &pos);
+
+                            // Asuming sequence C1 L1 S1 C2 L2 S2 ........ in fixed columns
+                            if(!readObservables(line, C1, L1, C2, L2, lliL1))
+                                {
+                                    std::cout << "Error parsing file: " << fname << "  at line: " << lineNumber << "\n";
+                                    std::cout << "Skipping the line\n";
+                                    continue;
+                                }
 
-                    if(line[0] == '>')
+                            // Now Calculate uncalibrated TEC from Phase
+                            GPS_ucTEC[SatID - 1].push_back(GPS_tau * c * ((L1 * Glmda1) - (L2 * Glmda2)) / TECU);
+                            GPS_Mark[SatID - 1] = 1;
+                            pushObservables(SatID - 1, C1, C2, L1, L2, lliL1);
+                            markNonZeroArcs(CONSTELLATION_ID_GPS, SatID);
+                        }
+                    else if(line[0] == 'R' && readGLO)
                         {
-                            // Epoch started, fill zeros for previous epoch
-                            if(epoch_counter != 0)
+                            // Processing GLONASS Line...
+                            if(line.size() < 85)
                                 {
-                                    pad_zero();
+                                    continue;
                                 }
-                            // Now increment Epoch Counter
-                            epoch_counter += 1;
 
-                            // read convert and push time in timeline
-                            // std::cout << line << "\t";
-                            epoch_time.parse(line);
-                            epoch_time.toUNIXTime();
-                            timeline_main.push_back(epoch_time.UNIX);
+                            tmp = line.substr(1);
+                            SatID = stoi(tmp, &pos);
+
+                            // Asuming sequence C1 L1 S1 C2 L2 S2 ........ in fixed columns
+                            if(!readObservables(line, C1, L1, C2, L2, lliL1))
+                                {
+                                    std::cout << "Error parsing file: " << fname << "  at line: " << lineNumber << "\n";
+                                    std::cout << "Skipping the line\n";
+                                    continue;
+                                }
+
+                            // Now Calculate uncalibrated TEC from Phase
+                            GLO_ucTEC[SatID - 1].push_back(GLO_tau * c * ((L1 * Rlmda1) - (L2 * Rlmda2)) / TECU);
+                            GLO_Mark[SatID - 1] = 1;
+                            pushObservables(GPS_SIZE + SatID - 1, C1, C2, L1, L2, lliL1);
+                            markNonZeroArcs(CONSTELLATION_ID_GLO, SatID);
                         }
-                    else
+                    else if(line[0] == 'E' && readGAL)
                         {
-                            if(line[0] == 'G' && readGPS)
+                            // Processing GALILEO Line...
+                            if(line.size() < 85)
                                 {
-                                    // Processing GPS Line...
-                                    if(line.size() < 85)
-                                        {
-                                            continue;
-                                        }
-
-                                    tmp = line.substr(1);
-                                    SatID = stoi(tmp, &pos);
-                                    tmp = tmp.substr(pos);
-
-                                    // Asuming sequence C1 lli L1 lli S1 C2 lli L2 lli S2 ........
-                                    // read in sequence the values L1 and L2
-                                    try
-                                        {
-                                            C1 = stof(tmp, &pos);
-                                            tmp = tmp.substr(pos);
-
-                                            lli = stoi(tmp, &pos);
-                                            tmp = tmp.substr(pos);
-
-                                            L1 = stof(tmp, &pos);
-                                            tmp = tmp.substr(pos);
-
-                                            lli = stoi(tmp, &pos);
-                                            tmp = tmp.substr(pos);
-
-                                            C2 = stof(tmp, &pos);
-                                            tmp = tmp.substr(pos);
-
-                                            C2 = stof(tmp, &pos);
-                                            tmp = tmp.substr(pos);
-
-                                            lli = stoi(tmp, &pos);
-                                            tmp = tmp.substr(pos);
-
-                                            L2 = stof(tmp, &pos);
-                                        }
-                                    catch(std::exception& e)
-                                        {
-                                            std::cout << "Exception occured..  " << e.what() << "\n";
-                                            std::cout << "Error parsing file: " << fname << "  at line: " << lineNumber << "\n";
-                                            std::cout << "Skipping the line\n";
-                                            continue;
-                                        }
-
-                                    // Now Calculate uncalibrated TEC from Phase
-                                    GPS_ucTEC[SatID - 1].push_back(GPS_tau * c * ((L1 * Glmda1) - (L2 * Glmda2)) / TECU);
-                                    GPS_Mark[SatID - 1] = 1;
-                                    markNonZeroArcs(CONSTELLATION_ID_GPS, SatID);
+                                    continue;
                                 }
-                            else if(line[0] == 'R' && readGLO)
+
+                            tmp = line.substr(1);
+                            SatID = stoi(tmp, &pos);
+
+                            // Asuming sequence C1 L1 S1 C2 L2 S2 ........ in fixed columns
+                            if(!readObservables(line, C1, L1, C2, L2, lliL1))
                                 {
-                                    // Processing GLONASS Line...
-                                    if(line.size() < 85)
-                                        {
-                                            continue;
-                                        }
-
-                                    tmp = line.substr(1);
-                                    SatID = stoi(tmp, &pos);
-                                    tmp = tmp.substr(pos);
-
-                                    // Asuming sequence C1 lli L1 lli S1 C2 lli L2 lli S2 ........
-                                    // read in sequence the values L1 and L2
-                                    try
-                                        {
-                                            C1 = stof(tmp, &pos);
-                                            tmp = tmp.substr(pos);
-
-                                            lli = stoi(tmp, &pos);
-                                            tmp = tmp.substr(pos);
-
-                                            L1 = stof(tmp, &pos);
-                                            tmp = tmp.substr(pos);
-
-                                            lli = stoi(tmp, &pos);
-                                            tmp = tmp.substr(pos);
-
-                                            C2 = stof(tmp, &pos);
-                                            tmp = tmp.substr(pos);
-
-                                            C2 = stof(tmp, &pos);
-                                            tmp = tmp.substr(pos);
-
-                                            lli = stoi(tmp, &pos);
-                                            tmp = tmp.substr(pos);
-
-                                            L2 = stof(tmp, &pos);
-                                        }
-                                    catch(std::exception& e)
-                                        {
-                                            std::cout << "Exception occured..  " << e.what() << "\n";
-                                            std::cout << "Error parsing file: " << fname << "  at line: " << lineNumber << "\n";
-                                            std::cout << "Skipping the line\n";
-                                            continue;
-                                        }
-
-                                    // Now Calculate uncalibrated TEC from Phase
-                                    GLO_ucTEC[SatID - 1].push_back(GLO_tau * c * ((L1 * Rlmda1) - (L2 * Rlmda2)) / TECU);
-                                    GLO_Mark[SatID - 1] = 1;
-                                    markNonZeroArcs(CONSTELLATION_ID_GLO, SatID);
+                                    std::cout << "Error parsing file: " << fname << "  at line: " << lineNumber << "\n";
+                                    std::cout << "Skipping the line\n";
+                                    continue;
                                 }
-                            else if(line[0] == 'E' && readGAL)
+
+                            // Now Calculate uncalibrated TEC from Phase
+                            GAL_ucTEC[SatID - 1].push_back(GAL_tau * c * ((L1 * Elmda1) - (L2 * Elmda2)) / TECU);
+                            GAL_Mark[SatID - 1] = 1;
+                            pushObservables(GPS_SIZE + GLO_SIZE + SatID - 1, C1, C2, L1, L2, lliL1);
+                            markNonZeroArcs(CONSTELLATION_ID_GAL, SatID);
+                        }
+                    else if(line[0] == 'C' && readBEI)
+                        {
+                            // Processing BEIDOU Line...
+                            if(line.size() < 85)
                                 {
-                                    // Processing GALILEO Line...
-                                    if(line.size() < 85)
-                                        {
-                                            continue;
-                                        }
-
-                                    tmp = line.substr(1);
-                                    SatID = stoi(tmp, &pos);
-                                    tmp = tmp.substr(pos);
-
-                                    // Asuming sequence C1 lli L1 lli S1 C2 lli L2 lli S2 ........
-                                    // read in sequence the values L1 and L2
-                                    try
-                                        {
-                                            C1 = stof(tmp, &pos);
-                                            tmp = tmp.substr(pos);
-
-                                            lli = stoi(tmp, &pos);
-                                            tmp = tmp.substr(pos);
-
-                                            L1 = stof(tmp, &pos);
-                                            tmp = tmp.substr(pos);
-
-                                            lli = stoi(tmp, &pos);
-                                            tmp = tmp.substr(pos);
-
-                                            C2 = stof(tmp, &pos);
-                                            tmp = tmp.substr(pos);
-
-                                            C2 = stof(tmp, &pos);
-                                            tmp = tmp.substr(pos);
-
-                                            lli = stoi(tmp, &pos);
-                                            tmp = tmp.substr(pos);
-
-                                            L2 = stof(tmp, &pos);
-                                        }
-                                    catch(std::exception& e)
-                                        {
-                                            std::cout << "Exception occured..  " << e.what() << "\n";
-                                            std::cout << "Error parsing file: " << fname << "  at line: " << lineNumber << "\n";
-                                            std::cout << "Skipping the line\n";
-                                            continue;
-                                        }
-
-                                    // Now Calculate uncalibrated TEC from Phase
-                                    GAL_ucTEC[SatID - 1].push_back(GAL_tau * c * ((L1 * Elmda1) - (L2 * Elmda2)) / TECU);
-                                    GAL_Mark[SatID - 1] = 1;
-                                    markNonZeroArcs(CONSTELLATION_ID_GAL, SatID);
+                                    continue;
                                 }
-                            else if(line[0] == 'C' && readBEI)
+
+                            tmp = line.substr(1);
+                            SatID = stoi(tmp, &pos);
+
+                            // Asuming sequence C1 L1 S1 C2 L2 S2 ........ in fixed columns
+                            if(!readObservables(line, C1, L1, C2, L2, lliL1))
                                 {
-                                    // Processing BEIDOU Line...
-                                    if(line.size() < 85)
-                                        {
-                                            continue;
-                                        }
-
-                                    tmp = line.substr(1);
-                                    SatID = stoi(tmp, &pos);
-                                    tmp = tmp.substr(pos);
-
-                                    // Asuming sequence C1 lli L1 lli S1 C2 lli L2 lli S2 ........
-                                    // read in sequence the values L1 and L2
-                                    try
-                                        {
-                                            C1 = stof(tmp, &pos);
-                                            tmp = tmp.substr(pos);
-
-                                            lli = stoi(tmp, &pos);
-                                            tmp = tmp.substr(pos);
-
-                                            L1 = stof(tmp, &pos);
-                                            tmp = tmp.substr(pos);
-
-                                            lli = stoi(tmp, &pos);
-                                            tmp = tmp.substr(pos);
-
-                                            C2 = stof(tmp, &pos);
-                                            tmp = tmp.substr(pos);
-
-                                            C2 = stof(tmp, &pos);
-                                            tmp = tmp.substr(pos);
-
-                                            lli = stoi(tmp, &pos);
-                                            tmp = tmp.substr(pos);
-
-                                            L2 = stof(tmp, &pos);
-                                        }
-                                    catch(std::exception& e)
-                                        {
-                                            std::cout << "Exception occured..  " << e.what() << "\n";
-                                            std::cout << "Error parsing file: " << fname << "  at line: " << lineNumber << "\n";
-                                            std::cout << "Skipping the line\n";
-                                            continue;
-                                        }
-
-                                    // Now Calculate uncalibrated TEC from Phase
-                                    BDU_ucTEC[SatID - 1].push_back(BDU_tau * c * ((L1 * Blmda1) - (L2 * Blmda2)) / TECU);
-                                    BDU_Mark[SatID - 1] = 1;
-                                    markNonZeroArcs(CONSTELLATION_ID_BDU, SatID);
+                                    std::cout << "Error parsing file: " << fname << "  at line: " << lineNumber << "\n";
+                                    std::cout << "Skipping the line\n";
+                                    continue;
                                 }
+
+                            // Now Calculate uncalibrated TEC from Phase
+                            BDU_ucTEC[SatID - 1].push_back(BDU_tau * c * ((L1 * Blmda1) - (L2 * Blmda2)) / TECU);
+                            BDU_Mark[SatID - 1] = 1;
+                            pushObservables(GPS_SIZE + GLO_SIZE + GAL_SIZE + SatID - 1, C1, C2, L1, L2, lliL1);
+                            markNonZeroArcs(CONSTELLATION_ID_BDU, SatID);
                         }
                 }
-            // Now pad zero for the last epoch
-            pad_zero();
-
-            // Closing Input file
-            inputFile.close();
         }
+};
 
-    // Now set Non zero arc markings
-    getnumNonZeroArcs();
+bool ObsData::setInterval()
+{
+    // Interval is optional in Header, take it from first two epochs otherwise
+    if(interval <= 0 && timeline_main.size() > 1)
+        {
+            interval = timeline_main[1] - timeline_main[0];
+        }
+    if(interval < decimation)
+        {
+            interval = decimation;
+        }
+    return interval > 0;
 };
 
 int ObsData::dumpArc(char sys, int prn)
@@ -765,59 +817,139 @@ void ObsData::markNonZeroArcs(int constellation, int prn)
 
 void ObsData::setArcStartEnd()
 {
-    float* s = NULL;
-    float* e = NULL;
-    //This routine sets the pointer pair(start,end) vetor of arcs
-    //assuming reduced data set, from begining and end as per
-    //Number of hours to reject variable
-    int reject = (12 * 60 * 60) / interval;
-    
+    char sys;
+    int prn;
+    //This routine sets one arc (start,end epochs) per satellite having data,
+    //over all epochs read, as epochs out of the needed window are not read at all
+    arcs.clear();
     for(int i = 0; i < 120; ++i)
         {
             //check in mark array
             if(NonZero_Mark[i] == 1)
                 {
-                    if(i < 32)
-                        {
-                            //GPS Arc
-                            s = reinterpret_cast<float*>(&*GPS_ucTEC[i].begin()+reject);
-                            e = reinterpret_cast<float*>(&*GPS_ucTEC[i].end()-reject);
-                            arcs.push_back(ptr_pair(s, e));
-                            //Aprn.push_back(i);
-                            //ASP.push_back(s);
-                        }
-                    else if(i < 56)
-                        {
-                            //GLONASS Arc
-                            s = reinterpret_cast<float*>(&*(GLO_ucTEC[i - 32].begin()+reject));
-                            e = reinterpret_cast<float*>(&*(GLO_ucTEC[i - 32].end()-reject));
-                            arcs.push_back(ptr_pair(s, e));
-                            //Aprn.push_back(i);
-                            //ASP.push_back(s);
-                        }
-                    else if(i < 86)
+                    arcs.add(i, 0, int(satSeries(i, sys, prn)->size()), 0);
+                }
+        }
+};
+
+std::vector<float>* ObsData::satSeries(int index, char& sys, int& prn)
+{
+    if(index < 32)
+        {
+            sys = 'G';
+            prn = index + 1;
+            return &GPS_ucTEC[index];
+        }
+    else if(index < 56)
+        {
+            sys = 'R';
+            prn = index - 32 + 1;
+            return &GLO_ucTEC[index - 32];
+        }
+    else if(index < 86)
+        {
+            sys = 'E';
+            prn = index - 56 + 1;
+            return &GAL_ucTEC[index - 56];
+        }
+    else
+        {
+            sys = 'C';
+            prn = index - 86 + 1;
+            return &BDU_ucTEC[index - 86];
+        }
+};
+
+void ObsData::setElevations(navigation& nav, int rh, int from, int to)
+{
+    //This routine computes satellite elevations at epochs having observations,
+    //positions are gathered in SoA buffers and passed to geometry in one batch per satellite
+    geometry geo(MarkerPosition, MarkerEllipsoidal, rh);
+    int sz = (to < 0) ? timeline_main.size() : to;
+    char sys;
+    int prn;
+    triple pos;
+
+    std::vector<int> idx;
+    std::vector<double> X, Y, Z;
+    std::vector<double> elev, azim, ippLat, ippLon, obliq;
+
+    if(from == 0 || satElevation.size() != 120)
+        {
+            satElevation.assign(120, std::vector<float>());
+        }
+
+    for(int i = 0; i < 120; ++i)
+        {
+            if(NonZero_Mark[i] != 1)
+                continue;
+
+            std::vector<float>& series = *satSeries(i, sys, prn);
+            const epochMask& mask = validEpochs[i];
+            idx.clear();
+            X.clear();
+            Y.clear();
+            Z.clear();
+            for(int k = from; k < sz && k < int(series.size()); ++k)
+                {
+                    if(mask.test(k) && nav.satPosition(sys, prn, timeline_main[k] / internalTime::NANO, pos))
                         {
-                            //GALILEO Arc
-                            s = reinterpret_cast<float*>(&*(GAL_ucTEC[i - 56].begin()+reject));
-                            e = reinterpret_cast<float*>(&*(GAL_ucTEC[i - 56].end()-reject));
-                            arcs.push_back(ptr_pair(s, e));
-                            //Aprn.push_back(i);
-                            //ASP.push_back(s);
+                            idx.push_back(k);
+                            X.push_back(pos.X);
+                            Y.push_back(pos.Y);
+                            Z.push_back(pos.Z);
                         }
-                    else if(i < 120)
+                }
+
+            int n = idx.size();
+            elev.resize(n);
+            azim.resize(n);
+            ippLat.resize(n);
+            ippLon.resize(n);
+            obliq.resize(n);
+            geo.compute(X.data(), Y.data(), Z.data(), n, elev.data(), azim.data(), ippLat.data(), ippLon.data(), obliq.data());
+
+            //earlier epochs are kept, new ones start as unknown
+            satElevation[i].resize(from, std::numeric_limits<float>::quiet_NaN());
+            satElevation[i].resize(sz, std::numeric_limits<float>::quiet_NaN());
+            for(int k = 0; k < n; ++k)
+                {
+                    satElevation[i][idx[k]] = elev[k] * toDegrees;
+                }
+        }
+};
+
+void ObsData::applyElevationMask(float minElevation, float maxElevation, int from, int to)
+{
+    char sys;
+    int prn;
+    for(int i = 0; i < int(satElevation.size()); ++i)
+        {
+            if(satElevation[i].size() == 0)
+                continue;
+
+            float* v = satSeries(i, sys, prn)->data();
+            const float* el = satElevation[i].data();
+            epochMask& mask = validEpochs[i];
+            int n = std::min(satElevation[i].size(), satSeries(i, sys, prn)->size());
+            if(to >= 0 && to < n)
+                n = to;
+
+            //NaN elevations compare false and are kept,
+            //values are zeroed too so that dumps show the cut
+            for(int k = from; k < n; ++k)
+                {
+                    if(el[k] < minElevation || el[k] > maxElevation)
                         {
-                            //BEIDOU Arc
-                            s = reinterpret_cast<float*>(&*(BDU_ucTEC[i - 86].begin()+reject));
-                            e = reinterpret_cast<float*>(&*(BDU_ucTEC[i - 86].end()-reject));
-                            arcs.push_back(ptr_pair(s, e));
-                            //Aprn.push_back(i);
-                            //ASP.push_back(s);
+                            mask.reset(k);
+                            v[k] = 0.0f;
                         }
                 }
         }
 };
 
-void ObsData::pre_process(int minArcLen, int intrpolIntrvl, int deg)
+void ObsData::pre_process(int minArcLen, int intrpolIntrvl, int deg, float minElevation, float maxElevation)
+
 {
     //This routine perform pre processing on internal data structure carrying arcs
     //Input: minArcLen = minimum arc length (minutes) to be considered valid for calibration
@@ -827,221 +959,635 @@ void ObsData::pre_process(int minArcLen, int intrpolIntrvl, int deg)
     // was found in the file or was requested to be processed, and only use the the flag array to define
     // the needed arcs to be pre-processed.
 
-    //setting start and end pointers for each arc (initially to the whole arc length)
-    //this would serve as input to other steps in pre-processing to modify arcs
-    setArcStartEnd();
-
     //pre processing step 1:
     //cut arcs when corresponding satellite elevation is out of minElevation and maxElevation
-    //to be implemented by means of processing navigation files
+    //using elevation series computed from navigation files, so that following steps
+    //do not work on data which would be discarded anyway
+    applyElevationMask(minElevation, maxElevation);
 
-    //pre-processing step 2 :
-    //cut arcs when there is no contiguous data for 5 mins (300 seconds)
-    //This means either satellite went out of sight or a long gap
-    float* s = NULL;
-    float* e = NULL;
-    float* p = NULL;
-    float* lastNonZero = NULL;
+    //setting start and end epochs for each arc (initially to the whole arc length)
+    //this would serve as input to other steps in pre-processing to modify arcs
+    setArcStartEnd();
 
-    for(auto arc : arcs)
+    //pre-processing steps 2 to 4 are independent per arc, each arc runs through
+    //all of them in one task, tasks are taken by worker threads from a shared counter
+    long long maxGap = intrpolIntrvl * internalTime::NANO;
+    int minEpochs = (minArcLen * 60 * internalTime::NANO) / interval;
+    int numTasks = arcs.size();
+    std::vector< std::vector<int_pair> > pieces(numTasks);
+    std::vector< std::vector<arcQuality> > quality(numTasks);
+    std::atomic<int> next(0);
+
+    auto worker = [&]() {
+        for(int j = next++; j < numTasks; j = next++)
+            {
+                preprocessArc(arcs.sat[j], arcs.start[j], arcs.end[j], minEpochs, maxGap, deg, pieces[j], quality[j]);
+            }
+    };
+
+    int numThreads = std::min(int(std::thread::hardware_concurrency()), numTasks);
+    if(numThreads <= 1)
+        {
+            worker();
+        }
+    else
         {
-            //Move the start
-            s = arc.start;
-            while(*s == 0.0)
+            std::vector<std::thread> workers;
+            for(int t = 0; t < numThreads; ++t)
                 {
-                    s += 1;
+                    workers.push_back(std::thread(worker));
                 }
-            //Move the end
-            e = arc.end;
-            while(*(e - 1) == 0.0)
+            for(auto& w : workers)
                 {
-                    e -= 1;
+                    w.join();
                 }
-            arcs2.push_back(ptr_pair(s, e));
         }
 
+    //arcs are replaced by their processed pieces, collected in arc order
+    //so that arc numbers do not depend on scheduling
+    arcTable processed;
+    for(int j = 0; j < numTasks; ++j)
+        {
+            for(std::size_t k = 0; k < pieces[j].size(); ++k)
+                {
+                    int_pair piece = pieces[j][k];
+                    size_of_S += piece.end - piece.start; //count all total values 
+                    int row = processed.add(arcs.sat[j], piece.start, piece.end, arcTable::PROCESSED);
+                    processed.setQuality(row, quality[j][k]);
+                }
+        }
+    arcs = processed;
 
+    //Pre-Processing is now complete
+};
 
-    int gap = 0;
-    bool arcNotBroken = true;
-    int arc2_counter = 0;
-    for(auto arc : arcs2)
+int ObsData::processClosedArcs(navigation& nav, int rh, int minArcLen, int intrpolIntrvl, int deg,
+                               float minElevation, float maxElevation, int& firstEpoch, int& lastEpoch, bool flush)
+{
+    //This routine is the incremental counterpart of pre_process, used while observation file grows.
+    //Last epoch may still receive satellite lines, so only epochs before it are considered.
+    //A segment of a satellite is closed once it is followed by a gap longer than intrpolIntrvl,
+    //closed segments are preprocessed and added to arcs, as markArcStartEnd does.
+    //On flush all epochs are closed and so are segments reaching the last one.
+    int closed = int(timeline_main.size()) - (flush ? 0 : 1);
+    if(closed < 1 || !setInterval())
+        return 0;
+
+    //elevations and mask only for epochs not yet seen
+    setElevations(nav, rh, elevationEpochs, closed);
+    applyElevationMask(minElevation, maxElevation, elevationEpochs, closed);
+    elevationEpochs = closed;
+
+    long long maxGap = intrpolIntrvl * internalTime::NANO;
+    int minEpochs = (minArcLen * 60 * internalTime::NANO) / interval;
+    int newArcs = 0;
+    std::vector<int_pair> pieces;
+    arcQuality quality;
+
+    for(int i = 0; i < 120; ++i)
         {
-            arcNotBroken = true;
-            s = p = arc.start;
-            while(p != arc.end)
+            if(NonZero_Mark[i] != 1)
+                continue;
+
+            const epochMask& mask = validEpochs[i];
+
+            int k = streamFrom[i];
+            while(true)
                 {
-                    //check if there is a gap
-                    if(*p == 0.0)
+                    //skip missing epochs before segment
+                    int start = mask.nextSet(k, closed);
+                    if(start == closed)
                         {
-                            gap += interval;
-                        }
-                    else
-                        {
-                            gap = 0;
-                            //set address of last non zero value
-                            lastNonZero = p;
+                            streamFrom[i] = closed;
+                            break;
                         }
 
-                    if(gap > intrpolIntrvl)
+                    //extend segment run by run until a gap longer than maxGap,
+                    //segment is open while such a gap is not seen before closed epoch
+                    int end = mask.nextClear(start, closed);
+                    bool open = true;
+                    while(end != closed)
                         {
-                            arcNotBroken = false;
-                            while(*p == 0.0)
+                            int next = mask.nextSet(end, closed);
+                            if((next - end) * interval > maxGap)
                                 {
-                                    ++p;
-                                }
-                            e = lastNonZero + 1;
-                            if(e - s >= (minArcLen * 60 / interval))
-                                {arcs3.push_back(ptr_pair(s, e));
-                                //ASP3.push_back(ASP[arc2_counter]);
-                                //Aprn3.push_back(Aprn[arc2_counter]);
+                                    open = false;
+                                    break;
                                 }
-                            gap = 0;
-                            s = p;
-                            lastNonZero = p;
+                            if(next == closed)
+                                break;
+                            end = mask.nextClear(next, closed);
+                        }
+                    if(open && !flush)
+                        {
+                            //segment still open, wait for more data
+                            streamFrom[i] = start;
+                            break;
                         }
-                    ++p;
+
+                    pieces.clear();
+                    splitAtSlips(i, start, end, minEpochs, pieces);
+                    for(auto piece : pieces)
+                        {
+                            int pstart = piece.start;
+                            int plast = piece.end - 1;
+                            processArc(i, pstart, plast + 1, deg, quality);
+                            size_of_S += plast + 1 - pstart;
+                            int row = arcs.add(i, pstart, plast + 1, arcTable::PROCESSED | arcTable::SOLUTION);
+                            arcs.setQuality(row, quality);
+                            firstEpoch = (newArcs == 0 || pstart < firstEpoch) ? pstart : firstEpoch;
+                            lastEpoch = (newArcs == 0 || plast > lastEpoch) ? plast : lastEpoch;
+                            newArcs += 1;
+                        }
+                    k = end;
                 }
-            if(arcNotBroken && (e - s) >= (minArcLen * 60 / interval))
+        }
+
+    numArcs = arcs.size();
+    return newArcs;
+};
+
+//Carrier frequencies of a satellite system ('G','R','E','C')
+static void frequencies(char sys, double& f1, double& f2)
+{
+    switch(sys)
+        {
+        case 'G':
+            f1 = GPS_f1;
+            f2 = GPS_f2;
+            break;
+        case 'R':
+            f1 = GLO_f1;
+            f2 = GLO_f2;
+            break;
+        case 'E':
+            f1 = GAL_f1;
+            f2 = GAL_f2;
+            break;
+        default:
+            f1 = BDU_f1;
+            f2 = BDU_f2;
+        }
+};
+
+void ObsData::findSlips(int index, int from, int to, std::vector<int>& slips)
+{
+    //This routine finds cycle slips of a satellite in epochs [from, to), using
+    //loss of lock flags, Melbourne-Wubbena combination and geometry-free phase.
+    //Combinations are computed first in plain loops over the SoA store (vectorizable),
+    //then a single sequential pass tests them.
+    char sys;
+    int prn;
+    const float* gf = satSeries(index, sys, prn)->data();
+    const double* C1 = code1[index].data();
+    const double* C2 = code2[index].data();
+    const double* WL = wideLane[index].data();
+    const unsigned char* lli = lossOfLock[index].data();
+    const epochMask& mask = validEpochs[index];
+
+    double f1, f2;
+    frequencies(sys, f1, f2);
+    //narrow-lane code in wide-lane cycles
+    double k1 = f1 * (f1 - f2) / ((f1 + f2) * c);
+    double k2 = f2 * (f1 - f2) / ((f1 + f2) * c);
+
+    int n = to - from;
+    std::vector<double> mw(n);
+    std::vector<double> d2(n);
+    double NaN = std::numeric_limits<double>::quiet_NaN();
+
+    //Melbourne-Wubbena (wide-lane cycles), NaN where there is no code
+    for(int k = 0; k < n; ++k)
+        {
+            int e = from + k;
+            bool valid = mask.test(e) && (C1[e] != 0.0) && (C2[e] != 0.0);
+            mw[k] = valid ? WL[e] - (k1 * C1[e] + k2 * C2[e]) : NaN;
+        }
+
+    //geometry-free second difference (TECU), only over three consecutive epochs with data
+    d2[0] = 0.0;
+    if(n > 1)
+        d2[1] = 0.0;
+    for(int k = 2; k < n; ++k)
+        {
+            int e = from + k;
+            bool valid = mask.test(e) && mask.test(e - 1) && mask.test(e - 2);
+            d2[k] = valid ? (gf[e] - 2.0 * gf[e - 1] + gf[e - 2]) : 0.0;
+        }
+
+    //sequential test, Melbourne-Wubbena against running mean since last slip
+    double mean = 0.0;
+    double var = 0.0;
+    int count = 0;
+    for(int k = 0; k < n; ++k)
+        {
+            if(!mask.test(from + k))
+                continue;
+
+            bool slip = (lli[from + k] & 1) != 0;
+            slip = slip || std::fabs(d2[k]) > GF_SLIP_TECU;
+            if(count > 1 && !std::isnan(mw[k]))
                 {
-                    arcs3.push_back(arc);
-                    //ASP3.push_back(ASP[arc2_counter]);
-                    //Aprn3.push_back(Aprn[arc2_counter]);
+                    double threshold = std::max(MW_SLIP_SIGMAS * std::sqrt(var / count), MW_SLIP_MIN);
+                    slip = slip || std::fabs(mw[k] - mean) > threshold;
+                }
+
+            if(slip && k > 0)
+                {
+                    slips.push_back(from + k);
+                    mean = var = 0.0;
+                    count = 0;
+                    //next second differences would span the slip
+                    if(k + 1 < n)
+                        d2[k + 1] = 0.0;
+                    if(k + 2 < n)
+                        d2[k + 2] = 0.0;
+                    continue;
+                }
+
+            if(!std::isnan(mw[k]))
+                {
+                    //Welford update of mean and sum of squared deviations
+                    count += 1;
+                    double delta = mw[k] - mean;
+                    mean += delta / count;
+                    var += delta * (mw[k] - mean);
                 }
-                
-            arc2_counter += 1;
-            
         }
+};
 
-    //pre-processing step 3 :
-    //Interpolate missing values
-    for(auto arc : arcs3)
+void ObsData::splitAtSlips(int index, int from, int to, int minEpochs, std::vector<int_pair>& pieces)
+{
+    char sys;
+    int prn;
+    float* v = satSeries(index, sys, prn)->data();
+    epochMask& mask = validEpochs[index];
+
+    std::vector<int> slips;
+    if(code1[index].size() >= std::size_t(to))
+        findSlips(index, from, to, slips);
+    slips.push_back(to);
+
+    //epoch of each slip is dropped, so that arc stays broken for markArcStartEnd
+    int start = from;
+    for(auto k : slips)
         {
-            size_of_S += arc.end - arc.start; //count all total values 
-            p = arc.start;
-            while(p != arc.end)
+            start = mask.nextSet(start, k);
+            int end = mask.lastSet(start, k);
+            if(end - start >= minEpochs)
+                pieces.push_back(int_pair(start, end));
+            if(k < to)
                 {
-                    if(*p == 0.0)
+                    mask.reset(k);
+                    v[k] = 0.0;
+                    start = k + 1;
+                }
+        }
+};
+
+void ObsData::preprocessArc(int index, int from, int to, int minEpochs, long long maxGap, int deg, std::vector<int_pair>& pieces,
+                            std::vector<arcQuality>& quality)
+{
+    const epochMask& mask = validEpochs[index];
+
+    //pre-processing step 2 :
+    //trim missing epochs at both ends of arc
+    int s = mask.nextSet(from, to);
+    int e = mask.lastSet(s, to);
+    //Arc has not enough data left (e.g. masked by elevation)
+    if(mask.count(s, e) < minEpochs)
+        {
+            return;
+        }
+
+    //cut arc when there is no contiguous data for intrpolIntrvl seconds
+    //This means either satellite went out of sight or a long gap,
+    //gaps are found run by run on validity words
+    std::vector<int_pair> segments;
+    int runEnd = mask.nextClear(s, e);
+    while(runEnd != e)
+        {
+            int next = mask.nextSet(runEnd, e);
+            if((next - runEnd) * interval > maxGap)
+                {
+                    if(runEnd - s >= minEpochs)
+                        segments.push_back(int_pair(s, runEnd));
+                    s = next;
+                }
+            runEnd = mask.nextClear(next, e);
+        }
+    if(e - s >= minEpochs)
+        segments.push_back(int_pair(s, e));
+
+    //split segments at cycle slips, so that levelling does not smooth over them
+    std::vector<int_pair> split;
+    for(auto segment : segments)
+        {
+            splitAtSlips(index, segment.start, segment.end, minEpochs, split);
+        }
+
+    //pre-processing steps 3 and 4 on each piece, while its data is in cache
+    arcQuality q;
+    for(auto piece : split)
+        {
+            processArc(index, piece.start, piece.end, deg, q);
+            pieces.push_back(piece);
+            quality.push_back(q);
+        }
+};
+
+void ObsData::levelArcs()
+{
+    //This routine levels each processed phase arc to code-derived TEC (carrier-to-code levelling).
+    //Level is the mean of code minus phase TEC over epochs having code, weighted by squared sine
+    //of elevation so that low elevation multipath weighs less. Weights and differences are
+    //gathered first, then reduced with independent partial sums so that the loop vectorizes.
+    char sys;
+    int prn;
+    double f1, f2;
+    std::vector<double> w;
+    std::vector<double> d;
+
+    for(int j = 0; j < arcs.size(); ++j)
+        {
+            if((arcs.flags[j] & arcTable::PROCESSED) == 0 || (arcs.flags[j] & arcTable::LEVELLED) != 0)
+                continue;
+
+            int i = arcs.sat[j];
+            int s = arcs.start[j];
+            int n = arcs.end[j] - s;
+            if(code1[i].size() < std::size_t(s + n))
+                continue;
+
+            float* v = satSeries(i, sys, prn)->data() + s;
+            const double* C1 = code1[i].data() + s;
+            const double* C2 = code2[i].data() + s;
+            const epochMask& mask = validEpochs[i];
+            //without elevations all epochs weigh the same
+            const float* el = (satElevation.size() == 120 && satElevation[i].size() >= std::size_t(s + n)) ? satElevation[i].data() + s : NULL;
+            //carrier smoothed code if Hatch filter is enabled
+            const float* H = (codeTEC[i].size() >= std::size_t(s + n)) ? codeTEC[i].data() + s : NULL;
+            frequencies(sys, f1, f2);
+            double tau = 1.0 / (40.3 * ((1.0 / (f2 * f2)) - (1.0 / (f1 * f1))));
+
+            w.resize(n);
+            d.resize(n);
+            for(int k = 0; k < n; ++k)
+                {
+                    double elevation = (el != NULL) ? el[k] : 90.0;
+                    bool code = (H != NULL) ? !std::isnan(H[k]) : (C1[k] != 0.0 && C2[k] != 0.0);
+                    //NaN elevation fails the comparison
+                    bool valid = mask.test(s + k) && code && elevation > 0.0;
+                    double sine = valid ? std::sin(elevation * toRadians) : 0.0;
+                    w[k] = sine * sine;
+                    d[k] = valid ? (((H != NULL) ? H[k] : tau * (C2[k] - C1[k]) / TECU) - v[k]) : 0.0;
+                }
+
+            double sw[4] = { 0.0, 0.0, 0.0, 0.0 };
+            double swd[4] = { 0.0, 0.0, 0.0, 0.0 };
+            int k = 0;
+            for(; k + 4 <= n; k += 4)
+                {
+                    for(int u = 0; u < 4; ++u)
                         {
-                            //Do interpolation
-                            lagrangeInterpolation(p, arc.start, arc.end, deg);
+                            sw[u] += w[k + u];
+                            swd[u] += w[k + u] * d[k + u];
                         }
-                    ++p;
                 }
+            for(; k < n; ++k)
+                {
+                    sw[0] += w[k];
+                    swd[0] += w[k] * d[k];
+                }
+            double weight = (sw[0] + sw[1]) + (sw[2] + sw[3]);
+            if(weight <= 0.0)
+                continue;
+            float level = ((swd[0] + swd[1]) + (swd[2] + swd[3])) / weight;
+
+            for(k = 0; k < n; ++k)
+                {
+                    v[k] += mask.test(s + k) ? level : 0.0f;
+                }
+            arcs.level[j] += level;
+            arcs.flags[j] |= arcTable::LEVELLED;
+        }
+};
+
+//Average of order statistics lo and hi (hi is lo or lo + 1) of [first, last),
+//found by selection, range is reordered.
+static float orderStatistics(float* first, float* last, int lo, int hi)
+{
+    std::nth_element(first, first + hi, last);
+    float high = first[hi];
+    if(lo == hi)
+        return high;
+    //after selection values before hi are not greater, lo is the largest of them
+    float low = *std::max_element(first, first + hi);
+    return (low + high) / 2.0;
+}
+
+//RMS of first differences and standard deviation of rate of TEC of an arc,
+//from sum and sum of squares of its n first differences (TECU)
+static void differenceStatistics(double sum, double sumSq, int n, float t2minust1, arcQuality& quality)
+{
+    quality.fdRms = 0.0f;
+    quality.rotStd = 0.0f;
+    if(n < 1)
+        return;
+    double mean = sum / n;
+    double variance = sumSq / n - mean * mean;
+    quality.fdRms = std::sqrt(sumSq / n);
+    //differences per interval to TECU/min
+    quality.rotStd = (variance > 0.0) ? std::sqrt(variance) * 60.0 / t2minust1 : 0.0;
+};
+
+void ObsData::hatchFilter(int index, int from, int to)
+{
+    char sys;
+    int prn;
+    double f1, f2;
+    std::vector<float>* series = satSeries(index, sys, prn);
+    const float* v = series->data();
+    const epochMask& mask = validEpochs[index];
+    //arcs of a satellite are processed by one thread, vector is sized once for all of them
+    std::vector<float>& out = codeTEC[index];
+    if(out.size() < series->size())
+        out.resize(series->size(), std::numeric_limits<float>::quiet_NaN());
+    if(code1[index].size() < std::size_t(to) || interval <= 0)
+        return;
+    const double* C1 = code1[index].data();
+    const double* C2 = code2[index].data();
+    frequencies(sys, f1, f2);
+    double tau = 1.0 / (40.3 * ((1.0 / (f2 * f2)) - (1.0 / (f1 * f1))));
+    int window = (hatchWindow * internalTime::NANO) / interval;
+    if(window < 1)
+        window = 1;
+
+    //n is number of code epochs in running mean, 0 until first one (or after restart)
+    int n = 0;
+    double smoothed = 0.0;
+    for(int k = from; k < to; ++k)
+        {
+            if(!mask.test(k))
+                {
+                    n = 0;
+                    out[k] = std::numeric_limits<float>::quiet_NaN();
+                    continue;
+                }
+            if(n > 0)
+                smoothed += v[k] - v[k - 1];
+            if(C1[k] != 0.0 && C2[k] != 0.0)
+                {
+                    n = (n < window) ? n + 1 : window;
+                    smoothed += (tau * (C2[k] - C1[k]) / TECU - smoothed) / n;
+                }
+            out[k] = (n > 0) ? smoothed : std::numeric_limits<float>::quiet_NaN();
+        }
+};
+
+void ObsData::processArc(int index, int from, int to, int deg, arcQuality& quality)
+{
+    char sys;
+    int prn;
+    float* v = satSeries(index, sys, prn)->data();
+    const epochMask& mask = validEpochs[index];
+    float* s = v + from;
+    float* e = v + to;
+    float* p = s;
+    quality.gaps = 0;
+    quality.filled = 0;
+    quality.outliers = 0;
+
+    //pre-processing step 3 :
+    //Interpolate missing values, one gap (run of missing epochs) at a time
+    int gap = mask.nextClear(from, to);
+    while(gap != to)
+        {
+            int gapEnd = mask.nextSet(gap, to);
+            //Do interpolation
+            if(fillGap(index, gap, gapEnd, from, to, deg) == 0)
+                {
+                    quality.gaps += 1;
+                    quality.filled += gapEnd - gap;
+                }
+            gap = mask.nextClear(gapEnd, to);
+        }
+
+    //carrier smoothing of code-derived TEC, on filled phase before out-liers are levelled
+    if(hatchWindow > 0)
+        {
+            hatchFilter(index, from, to);
         }
 
     //pre-processing step 4 :
     //calculate first differences, quartiles, and level out-liers
 
-    std::vector<float> FDiff;
-    std::vector<float> FDiff_sorted;
+    //first differences and selection buffer are kept per thread and reused across arcs,
+    //so that they grow to the longest arc once instead of being allocated for each arc
+    static thread_local std::vector<float> FDiff;
+    static thread_local std::vector<float> scratch;
+    FDiff.clear();
 
     //variables for quartiles
-    float Q1, Q2, Q3;
+    float Q1, Q3;
     int vec_size;
     //Inter Quartile Range
     float IQR;
     float lowerBound;
     float upperBound;
-    int t2minust1 = float(interval);
-    float sum;
+    float t2minust1 = float(interval) / internalTime::NANO;
+    //sums of first differences for quality metrics, taken with FDiff and
+    //taken again while levelling, where each difference is final when walked
+    double sum = 0.0;
+    double sumSq = 0.0;
+
+    p = s + 1;
+    while(p != e)
+        {
+            //there is nothing in division like t2 - t1
+            //because we have values each interval
+            //which means t2 - t1 will be fixed (interval) across arc
+            double d = *p - *(p - 1);
+            sum += d;
+            sumSq += d * d;
+            FDiff.push_back((*p - *(p - 1)) / t2minust1);
+            ++p;
+        }
 
-    for(auto arc : arcs3)
+    //Quartiles need only a few order statistics, selected in linear time
+    //(same positions as in sorted FDiff, median is not needed for bounds)
+    vec_size = FDiff.size();
+    if(vec_size < 4)
         {
-            p = arc.start + 1;
-            while(p != arc.end)
+            differenceStatistics(sum, sumSq, vec_size, t2minust1, quality);
+            return;
+        }
+    scratch.assign(FDiff.begin(), FDiff.end());
+    float* first = scratch.data();
+    float* last = first + vec_size;
+    if(vec_size % 2 == 0)
+        {
+            //Even
+            if((vec_size / 2) % 2 == 0)
                 {
-                    //there is nothing in division like t2 - t1
-                    //because we have values each interval
-                    //which means t2 - t1 will be fixed (interval) across arc
-                    FDiff.push_back((*p - *(p - 1)) / t2minust1);
-                    ++p;
+                    //Even
+                    Q1 = orderStatistics(first, last, (vec_size / 4) - 1, vec_size / 4);
+                    Q3 = orderStatistics(first, last, (vec_size / 4) * 3 - 1, (vec_size / 4) * 3);
                 }
-
-            //Now sort the FDiff for median and quartiles
-            FDiff_sorted = FDiff;
-            std::sort(FDiff_sorted.begin(), FDiff_sorted.end());
-            vec_size = FDiff_sorted.size();
-            if(vec_size % 2 == 0)
+            else
+                {
+                    //Odd
+                    Q1 = orderStatistics(first, last, (vec_size / 2 - 1) / 2, (vec_size / 2 - 1) / 2);
+                    Q3 = orderStatistics(first, last, (vec_size / 2) + (vec_size / 2 - 1) / 2, (vec_size / 2) + (vec_size / 2 - 1) / 2);
+                }
+        }
+    else
+        {
+            //Odd
+            if(((vec_size - 1) / 2) % 2 == 0)
                 {
                     //Even
-                    Q2 = (FDiff_sorted[(vec_size / 2) - 1] + FDiff_sorted[vec_size / 2]) / 2.0;
-                    if((vec_size / 2) % 2 == 0)
-                        {
-                            //Even
-                            Q1 = (FDiff_sorted[(vec_size / 4) - 1] + FDiff_sorted[vec_size / 4]) / 2.0;
-                            Q3 = (FDiff_sorted[(vec_size / 4) * 3 - 1] + FDiff_sorted[(vec_size / 4) * 3]) / 2.0;
-                        }
-                    else
-                        {
-                            //Odd
-                            Q1 = FDiff_sorted[(vec_size / 2 - 1) / 2];
-                            Q3 = FDiff_sorted[(vec_size / 2) + (vec_size / 2 - 1) / 2];
-                        }
+                    Q1 = orderStatistics(first, last, ((vec_size - 1) / 4) - 1, (vec_size - 1) / 4);
+                    Q3 = orderStatistics(first, last, ((vec_size - 1) / 4) * 3, ((vec_size - 1) / 4) * 3 + 1);
                 }
             else
                 {
                     //Odd
-                    Q2 = FDiff_sorted[(vec_size - 1) / 2];
-                    if(((vec_size - 1) / 2) % 2 == 0)
-                        {
-                            //Even
-                            Q1 = (FDiff_sorted[((vec_size - 1) / 4) - 1] + FDiff_sorted[(vec_size - 1) / 4]) / 2.0;
-                            Q3 = (FDiff_sorted[((vec_size - 1) / 4) * 3] + FDiff_sorted[((vec_size - 1) / 4) * 3 + 1]) / 2.0;
-                        }
-                    else
-                        {
-                            //Odd
-                            Q1 = FDiff_sorted[((vec_size - 1) / 2 - 1) / 2];
-                            Q3 = FDiff_sorted[(vec_size - 1) / 2 + ((vec_size - 1) / 2 + 1) / 2];
-                        }
+                    Q1 = orderStatistics(first, last, ((vec_size - 1) / 2 - 1) / 2, ((vec_size - 1) / 2 - 1) / 2);
+                    Q3 = orderStatistics(first, last, (vec_size - 1) / 2 + ((vec_size - 1) / 2 + 1) / 2, (vec_size - 1) / 2 + ((vec_size - 1) / 2 + 1) / 2);
                 }
+        }
 
-            //Now calculate IQR
-            IQR = Q3 - Q1;
-            lowerBound = Q1 - 1.5 * IQR;
-            upperBound = Q3 + 1.5 * IQR;
-
-            //Now go over the arc and remove out-liers
-            //by leveling them to partial mean around out-lier
-            //used vector here would be actual un-sorted FDiff
-            //so that we can track back the out-lier which caused that jump
-            p = arc.start + 1;
-            sum = 0.0;
-            for(auto val : FDiff)
+    //Now calculate IQR
+    IQR = Q3 - Q1;
+    lowerBound = Q1 - 1.5 * IQR;
+    upperBound = Q3 + 1.5 * IQR;
+
+    //Now go over the arc and remove out-liers
+    //by leveling them to Savitzky-Golay estimate from epochs around out-lier
+    //(window shifted inside arc near its ends)
+    //used vector here would be actual un-sorted FDiff
+    //so that we can track back the out-lier which caused that jump
+    //Epochs before p are final, so difference at p is that of levelled arc
+    sum = sumSq = 0.0;
+    p = s + 1;
+    for(auto val : FDiff)
+        {
+            if(val < lowerBound || val > upperBound)
                 {
-                    if(val < lowerBound || val > upperBound)
-                        {
-                            //p is the pointer to value that caused val as outlier
-                            if(((p - 3) >= arc.start) && ((p + 3) <= (arc.end - 1)))
-                                {
-                                    //get 3 prev points and 3 next points
-                                    sum = sum + *(p - 3) + *(p - 2) + *(p - 1);
-                                    sum = sum + *(p + 3) + *(p + 2) + *(p + 1);
-                                }
-                            else if(p - 3 < arc.start)
-                                {
-                                    //take 6 next points
-                                    sum = sum + *(p + 6) + *(p + 5) + *(p + 4) + *(p + 3) + *(p + 2) + *(p + 1);
-                                }
-                            else
-                                {
-                                    //take 6 prev points
-                                    sum = sum + *(p - 6) + *(p - 5) + *(p - 4) + *(p - 3) + *(p - 2) + *(p - 1);
-                                }
-
-                            //nnow set the out-lier equal to mean
-                            *p = sum / 6.0;
-                            sum = 0.0;
-                        }
-                    ++p;
+                    //p is the pointer to value that caused val as outlier
+                    *p = outlierFilter.estimate(s, e, p);
+                    quality.outliers += 1;
                 }
-
-            //clear vector
-            FDiff.clear();
+            double d = *p - *(p - 1);
+            sum += d;
+            sumSq += d * d;
+            ++p;
         }
 
-    //Pre-Processing is now complete
+    //quality metrics of levelled arc
+    differenceStatistics(sum, sumSq, vec_size, t2minust1, quality);
+
 };
 
 void ObsData::getnumNonZeroArcs()
@@ -1070,180 +1616,148 @@ void ObsData::dumpNonZeroArcs()
     std::cout << "Number of Total Non Zero Arcs:  " << numNonZeroArcs << "\n";
 };
 
-int ObsData::lagrangeInterpolation(float* target, float* s, float* e, int deg)
+//Barycentric weights for one pattern of interpolation nodes (epochs from gap start)
+struct lagrangeWeights
+{
+    int n;
+    int nodes[MAX_INTERPOLATION_DEGREE];
+    double w[MAX_INTERPOLATION_DEGREE];
+};
+
+int ObsData::fillGap(int index, int gs, int ge, int s, int e, int deg)
 {
-    if(deg % 2 != 0)
+    if(deg % 2 != 0 || deg < 2 || deg > MAX_INTERPOLATION_DEGREE)
         return -1;
-    //Traverse backwards from target
-    //untill:
-    //       you get int(deg/2) non-zero values
-    //       or you reach arc start (s) in which case also set direction flag
-    //       append numbers in vector xi
-    int half = int(deg / 2);
-    float* t = target - 1;
-    std::vector<float> xi = { 0.0 }; //xi pints for interpolation (ignore index 0)
-    std::vector<int> ti = { 0 };     //timeline for xi points (ignore index 0)
-    float* lastUp = NULL;
-    float* lastDown = NULL;
-
-    int time = 0;
-    bool upflag = false;
-    while(true)
-        {
-            time -= interval;
-            if(xi.size() - 1 == half)
-                break;
-            if(t == (s - 1))
-                {
-                    upflag = true;
-                    break;
-                }
 
-            if(*t != 0.0)
-                {
-                    xi.insert(xi.begin(), *t);
-                    ti.insert(ti.begin(), time);
-                    lastUp = t;
-                    --t;
-                }
-            else
+    char sys;
+    int prn;
+    float* v = satSeries(index, sys, prn)->data();
+    epochMask& mask = validEpochs[index];
+
+    //Nodes and values, kept on stack
+    int x[MAX_INTERPOLATION_DEGREE];
+    float f[MAX_INTERPOLATION_DEGREE];
+    int n = 0;
+    int half = deg / 2;
+    int before = gs - 1;
+    int after = ge;
+
+    //Traverse backwards from gap untill deg/2 valid values or arc start
+    while(n < half && before >= s)
+        {
+            if(mask.test(before))
                 {
-                    --t;
-                    continue;
+                    x[n] = before - gs;
+                    f[n] = v[before];
+                    ++n;
                 }
+            --before;
         }
-
-    //Traverse forwards from target
-    //untill:
-    //       you get deg - xi.size() non-zero values
-    //       or you reach arc end (e) in which case also set direction flag
-    //       append numbers in vector xi
-    bool downflag = false;
-    t = target + 1;
-    time = 0;
-    while(true)
+    //Traverse forwards from gap untill deg valid values or arc end
+    while(n < deg && after < e)
         {
-            time += interval;
-            if(xi.size() - 1 == deg)
-                break;
-            if(t == e)
+            if(mask.test(after))
                 {
-                    downflag = true;
-                    break;
+                    x[n] = after - gs;
+                    f[n] = v[after];
+                    ++n;
                 }
-
-            if(*t != 0.0)
+            ++after;
+        }
+    //If arc end was reached, get more points backwards
+    while(n < deg && before >= s)
+        {
+            if(mask.test(before))
                 {
-                    xi.push_back(*t);
-                    ti.push_back(time);
-                    lastDown = t;
-                    ++t;
+                    x[n] = before - gs;
+                    f[n] = v[before];
+                    ++n;
                 }
-            else
+            --before;
+        }
+    if(n < deg)
+        return -2;
+
+    //Look up weights for this node pattern, gaps of same length
+    //between continuous data share the same pattern
+    static thread_local lagrangeWeights cache[LAGRANGE_CACHE_SIZE];
+    static thread_local int cached = 0;
+    static thread_local int replace = 0;
+    lagrangeWeights* weights = NULL;
+    for(int c = 0; c < cached; ++c)
+        {
+            if(cache[c].n == n && std::equal(x, x + n, cache[c].nodes))
                 {
-                    ++t;
-                    continue;
+                    weights = &cache[c];
+                    break;
                 }
         }
-
-    //check if xi.size() == deg
-    //    YES ---> go for interpolation
-    //    NO:
-    //       get more points from direction for which flag not set
-    //       if both flags set, return -1 (not enough points)
-    if(xi.size() - 1 < deg)
+    if(weights == NULL)
         {
-            if(upflag && downflag)
+            if(cached < LAGRANGE_CACHE_SIZE)
                 {
-                    return -2;
+                    weights = &cache[cached];
+                    cached += 1;
                 }
-            else if(upflag)
+            else
                 {
-                    //go downward
-                    t = lastDown + 1;
-                    time = ti.back();
-                    while(true)
-                        {
-                            time += interval;
-                            if(xi.size() - 1 == deg)
-                                break;
-                            if(t == e)
-                                return -3;
-
-                            if(*t != 0.0)
-                                {
-                                    xi.push_back(*t);
-                                    ti.push_back(time);
-                                    ++t;
-                                }
-                        }
+                    weights = &cache[replace];
+                    replace = (replace + 1) % LAGRANGE_CACHE_SIZE;
                 }
-            else
+            weights->n = n;
+            for(int i = 0; i < n; ++i)
                 {
-                    //go upward
-                    t = lastUp - 1;
-                    time = *ti.begin();
-                    while(true)
+                    weights->nodes[i] = x[i];
+                    double product = 1.0;
+                    for(int j = 0; j < n; ++j)
                         {
-                            time -= interval;
-                            if(xi.size() - 1 == deg)
-                                break;
-                            if(t == (s - 1))
-                                return -4;
-                            if(*t != 0.0)
-                                {
-                                    xi.insert(xi.begin(), *t);
-                                    ti.insert(ti.begin(), time);
-                                    --t;
-                                }
+                            if(j != i)
+                                product = product * (x[i] - x[j]);
                         }
+                    weights->w[i] = 1.0 / product;
                 }
         }
 
-    //Now we have enough points for interpolation
-    float product1 = 1.0;
-    float product2 = 1.0;
-    float sum = 0.0;
-    for(int i = 0; i < ti.size(); ++i)
+    //Second barycentric form over the whole gap, nodes are never inside the gap
+    const double* w = weights->w;
+    float* target = v + gs;
+    int length = ge - gs;
+    for(int k = 0; k < length; ++k)
         {
-            if(ti[i] == 0)
-                continue;
-
-            for(int j = 0; j < ti.size(); ++j)
+            double numerator = 0.0;
+            double denominator = 0.0;
+            for(int i = 0; i < n; ++i)
                 {
-                    if(ti[j] == 0 || i == j)
-                        continue;
-
-                    product1 = product1 * (0.0 - ti[j]);
-                    product2 = product2 * (ti[i] - ti[j]);
+                    double c = w[i] / double(k - x[i]);
+                    numerator += c * f[i];
+                    denominator += c;
                 }
-            sum = sum + (xi[i] * product1 / product2);
-            product1 = product2 = 1.0;
+            target[k] = numerator / denominator;
+        }
+    //filled epochs are valid data for following steps
+    for(int k = gs; k < ge; ++k)
+        {
+            mask.set(k);
         }
-    *target = sum;
     return 0;
 };
 
 int ObsData::dumpArcBinaryPtrsAll()
 {
-    float* s = NULL;
-    float* e = NULL;
-    int arc_count = 0;
+    char sys;
+    int prn;
 
-    for(auto arc : arcs3)
+    for(int j = 0; j < arcs.size(); ++j)
         {
-            s = arc.start;
-            e = arc.end;
-            arc_count += 1;
-            std::cout << "Arc # " << arc_count << "\n";
+            const float* v = satSeries(arcs.sat[j], sys, prn)->data();
+            std::cout << "Arc # " << j + 1 << "\n";
 
-            while(s != e)
+            for(int k = arcs.start[j]; k < arcs.end[j]; ++k)
                 {
-                    if(*s == 0.0)
+                    if(v[k] == 0.0)
                         std::cout << 0;
                     else
                         std::cout << 1;
-                    ++s;
                 }
             std::cout << "\n";
         }
@@ -1252,179 +1766,174 @@ int ObsData::dumpArcBinaryPtrsAll()
 
 int ObsData::dumpArcValuePtrsAll()
 {
-    int arc_count = 0;
-    float* p = NULL;
+    char sys;
+    int prn;
 
-    for(auto arc : arcs3)
+    for(int j = 0; j < arcs.size(); ++j)
         {
-            arc_count += 1;
-            std::cout << "Arc # " << arc_count << "\n";
-            p = arc.start;
-            while(p != arc.end)
+            const float* v = satSeries(arcs.sat[j], sys, prn)->data();
+            std::cout << "Arc # " << j + 1 << "\n";
+            for(int k = arcs.start[j]; k < arcs.end[j]; ++k)
                 {
-                    std::cout << *p << ", ";
-                    ++p;
+                    std::cout << v[k] << ", ";
                 }
             std::cout << "\n\n";
         }
     return 0;
 };
 
+bool ObsData::writeArcQuality(const std::string& fileName)
+{
+    //temporary name unique to process, stations may be processed concurrently
+    std::string tmpName = fileName + "." + std::to_string(getpid()) + ".tmp";
+    std::ofstream out(tmpName.c_str(), std::ios::trunc);
+    if(!out.is_open())
+        return false;
+
+    out << "system,prn,start,end,epochs,gaps,interpolated,outliers,rotstd,fdrms,level\n";
+    for(int j = 0; j < arcs.size(); ++j)
+        {
+            int n = arcs.length(j);
+            out << arcs.system[j] << "," << arcs.prn(j) << ","
+                << timeline_main[arcs.start[j]] / internalTime::NANO << ","
+                << timeline_main[arcs.end[j] - 1] / internalTime::NANO << ","
+                << n << "," << arcs.gaps[j] << "," << float(arcs.filled[j]) / n << ","
+                << arcs.outliers[j] << "," << arcs.rotStd[j] << "," << arcs.fdRms[j] << ","
+                << arcs.level[j] << "\n";
+        }
+    out.close();
 
+    if(out.fail() || rename(tmpName.c_str(), fileName.c_str()) != 0)
+        {
+            remove(tmpName.c_str());
+            return false;
+        }
+    return true;
+};
 
-
-void ObsData::markArcStartEnd(int& rejHours, int& minArcHours)
+void ObsData::computeROTI(int windowSeconds)
 {
-    
-    istart = (rejHours * 60 * 60 ) / interval;
-    iend = timeline_main.size() - istart;
-    int minimum = (minArcHours * 60 * 60) / interval;
-
-    //start Marking
-    bool started = false;
-    int startidx = 0;
-    int endidx = 0;
-    int id = 0;
-    for(auto prn : GPS_ucTEC)
-    {
-        id += 1;
-        started = false;
-        startidx = 0;
-        endidx = 0;      
-        for(int i=istart;i<iend;++i)
-        {
-            if(prn[i] != 0.0)
-                if(started)
-                    continue;
-                else
-                {
-                    started = true;
-                    startidx = i;
-                }
-            else
-                if(started)
-                {
-                    endidx = i-1;
-                    if((i - startidx) >= minimum )
-                    {
-                        intse.push_back(int_pair(startidx,endidx));
-                        prnid.push_back(id);
-                    }
-                    started = false;
-                    startidx = endidx = 0;
-                }
-        }
-    }
-    
-    //For GLONASS
-    for(auto prn : GLO_ucTEC)
-    {
-        id += 1;
-        started = false;
-        startidx = 0;
-        endidx = 0;      
-        for(int i=istart;i<iend;++i)
-        {
-            if(prn[i] != 0.0)
-                if(started)
-                    continue;
-                else
+    //rows grow with timeline, new epochs are not defined until their arcs are computed
+    int epochs = timeline_main.size();
+    rot.resize(std::size_t(epochs) * 120, std::numeric_limits<float>::quiet_NaN());
+    roti.resize(std::size_t(epochs) * 120, std::numeric_limits<float>::quiet_NaN());
+    rotiWindow = windowSeconds;
+    if(interval <= 0)
+        return;
+
+    //window in rates (intervals), rate per interval to TECU/min
+    int w = (windowSeconds * internalTime::NANO) / interval;
+    double perMinute = 60.0 * internalTime::NANO / interval;
+    char sys;
+    int prn;
+    std::vector<float> r;
+    std::vector<double> s1;
+    std::vector<double> s2;
+    std::vector<int> count;
+
+    for(int j = 0; j < arcs.size(); ++j)
+        {
+            if((arcs.flags[j] & arcTable::PROCESSED) == 0 || (arcs.flags[j] & arcTable::ROTI) != 0)
+                continue;
+
+            int i = arcs.sat[j];
+            int s = arcs.start[j];
+            int n = arcs.end[j] - s;
+            const float* v = satSeries(i, sys, prn)->data() + s;
+            const epochMask& mask = validEpochs[i];
+
+            //rate of TEC between consecutive valid epochs, and prefix sums over arc
+            r.assign(n, 0.0f);
+            s1.assign(n + 1, 0.0);
+            s2.assign(n + 1, 0.0);
+            count.assign(n + 1, 0);
+            for(int k = 1; k < n; ++k)
                 {
-                    started = true;
-                    startidx = i;
+                    bool valid = mask.test(s + k) && mask.test(s + k - 1);
+                    r[k] = valid ? (v[k] - v[k - 1]) * perMinute : 0.0f;
+                    rot[std::size_t(s + k) * 120 + i] = valid ? r[k] : std::numeric_limits<float>::quiet_NaN();
+                    s1[k + 1] = s1[k] + r[k];
+                    s2[k + 1] = s2[k] + double(r[k]) * r[k];
+                    count[k + 1] = count[k] + (valid ? 1 : 0);
                 }
-            else
-                if(started)
+
+            //window of w rates ending at epoch k, rates start at epoch 1 of arc
+            for(int k = w; k < n && w > 1; ++k)
                 {
-                    endidx = i-1;
-                    if((i - startidx) >= minimum )
-                    {
-                        intse.push_back(int_pair(startidx,endidx));
-                        prnid.push_back(id);
-                    }
-                    started = false;
-                    startidx = endidx = 0;
+                    double mean = (s1[k + 1] - s1[k + 1 - w]) / w;
+                    double variance = (s2[k + 1] - s2[k + 1 - w]) / w - mean * mean;
+                    bool full = (count[k + 1] - count[k + 1 - w]) == w;
+                    roti[std::size_t(s + k) * 120 + i] = full ? std::sqrt(variance > 0.0 ? variance : 0.0) : std::numeric_limits<float>::quiet_NaN();
                 }
+            arcs.flags[j] |= arcTable::ROTI;
         }
-    }    
-    
-    //For GALILEO
-    for(auto prn : GAL_ucTEC)
-    {
-        id += 1;
-        started = false;
-        startidx = 0;
-        endidx = 0;      
-        for(int i=istart;i<iend;++i)
-        {
-            if(prn[i] != 0.0)
-                if(started)
-                    continue;
-                else
-                {
-                    started = true;
-                    startidx = i;
-                }
-            else
-                if(started)
-                {
-                    endidx = i-1;
-                    if((i - startidx) >= minimum )
-                    {
-                        intse.push_back(int_pair(startidx,endidx));
-                        prnid.push_back(id);
-                    }
-                    started = false;
-                    startidx = endidx = 0;
-                }
+};
+
+bool ObsData::writeROTI(const std::string& fileName)
+{
+    //temporary name unique to process, stations may be processed concurrently
+    std::string tmpName = fileName + "." + std::to_string(getpid()) + ".tmp";
+    std::ofstream out(tmpName.c_str(), std::ios::binary | std::ios::trunc);
+    if(!out.is_open())
+        return false;
+
+    int32_t header[3];
+    header[0] = timeline_main.size();
+    header[1] = 120;
+    header[2] = rotiWindow;
+    out.write("ROTI", 4);
+    out.write((const char*)header, sizeof(header));
+    out.write((const char*)timeline_main.data(), timeline_main.size() * sizeof(long long));
+    out.write((const char*)rot.data(), rot.size() * sizeof(float));
+    out.write((const char*)roti.data(), roti.size() * sizeof(float));
+    out.close();
+
+    if(out.fail() || rename(tmpName.c_str(), fileName.c_str()) != 0)
+        {
+            remove(tmpName.c_str());
+            return false;
         }
-    }    
+    return true;
+};
+
+void ObsData::markArcStartEnd(int& rejHours, int& minArcHours)
+{
     
-    //For BEIDOU
-    for(auto prn : BDU_ucTEC)
+    //solution window is taken in time, from epoch window if one was set
+    long long reject = rejHours * 60 * 60 * internalTime::NANO;
+    long long first = timeline_main.empty() ? 0 : timeline_main.front();
+    long long last = timeline_main.empty() ? 0 : timeline_main.back() + interval;
+    if(windowStart != std::numeric_limits<long long>::min())
+        first = windowStart;
+    if(windowEnd != std::numeric_limits<long long>::max())
+        last = windowEnd;
+    istart = std::lower_bound(timeline_main.begin(), timeline_main.end(), first + reject) - timeline_main.begin();
+    iend = std::lower_bound(timeline_main.begin(), timeline_main.end(), last - reject) - timeline_main.begin();
+    int minimum = (minArcHours * 60 * 60 * internalTime::NANO) / interval;
+
+    //start Marking, arcs are cut to [istart, iend) and at epochs left missing
+    //by preprocessing, runs reaching iend and shorter than minimum are dropped
+    arcTable marked;
+    for(int j = 0; j < arcs.size(); ++j)
     {
-        id += 1;
-        started = false;
-        startidx = 0;
-        endidx = 0;      
-        for(int i=istart;i<iend;++i)
-        {
-            if(prn[i] != 0.0)
-                if(started)
-                    continue;
-                else
-                {
-                    started = true;
-                    startidx = i;
-                }
-            else
-                if(started)
-                {
-                    endidx = i-1;
-                    if((i - startidx) >= minimum )
-                    {
-                        intse.push_back(int_pair(startidx,endidx));
-                        prnid.push_back(id);
-                    }
-                    started = false;
-                    startidx = endidx = 0;
-                }
+        const epochMask& mask = validEpochs[arcs.sat[j]];
+        int from = std::max(arcs.start[j], istart);
+        int to = std::min(arcs.end[j], iend);
+        int startidx = mask.nextSet(from, to);
+        while(startidx != to)
+        {
+            int endidx = mask.nextClear(startidx, to);
+            if(endidx == iend)
+                break;
+            if((endidx - startidx) >= minimum)
+            {
+                int row = marked.add(arcs.sat[j], startidx, endidx, arcs.flags[j] | arcTable::SOLUTION);
+                marked.level[row] = arcs.level[j];
+                marked.setQuality(row, arcs.quality(j));
+            }
+            startidx = mask.nextSet(endidx, to);
         }
     }
+    arcs = marked;
+    numArcs = arcs.size();
 };
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
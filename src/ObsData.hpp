@@ -36,8 +36,12 @@
 #include <vector>
 #include "internalTime.hpp"
 #include "triple.hpp"
-#include "ptr_pair.hpp"
 #include "int_pair.hpp"
+#include "epochMask.hpp"
+#include "arcTable.hpp"
+#include "savitzkyGolay.hpp"
+
+class navigation;
 
 
 /**
@@ -63,6 +67,71 @@ class ObsData
         */
         void read();
 	
+	//!Function to read observation Header.
+        /*!Reads Header lines up to "END OF HEADER" and sets Header dependent members,
+	 * including @ref MarkerEllipsoidal.
+	 * @param inputFile Stream positioned at first Header line.
+	 * @param lineNumber Line counter, incremented for each line read.
+	 * @return Returns false if stream ended before "END OF HEADER".
+	 */
+        bool readHeader(std::istream& inputFile, int& lineNumber);
+	
+	//!Function to read observation records.
+        /*!Reads epoch and satellite lines till end of stream, appending to @ref timeline_main
+	 * and raw non-calibrated TEC vectors. Last epoch read is left open (not zero padded),
+	 * so reading can be resumed with further lines of the same file.
+	 * @param inputFile Stream positioned after Header, or at start of further lines.
+	 * @param fname File name, used in messages.
+	 * @param lineNumber Line counter, incremented for each line read.
+	 * @param epoch_counter Number of epochs kept from this file, 0 before first call.
+	 * @param skipEpoch Whether last epoch was skipped by epoch filter, false before first call.
+	 */
+        void readRecords(std::istream& inputFile, const std::string& fname, int& lineNumber, int& epoch_counter, bool& skipEpoch);
+	
+	//!Function to read observables of a satellite line.
+        /*!Observables are read in fixed columns, assuming sequence C1 L1 S1 C2 L2: satellite id (3 columns),
+	 * then for each observable a F14.3 value, I1 loss of lock indicator (LLI) and I1 signal strength.
+	 * Blank fields read as 0.
+	 * @param line Satellite line.
+	 * @param C1 Output C1 pseudorange (meters).
+	 * @param L1 Output L1 phase (cycles).
+	 * @param C2 Output C2 pseudorange (meters).
+	 * @param L2 Output L2 phase (cycles).
+	 * @param lliL1 Output LLI of L1 phase (0 if blank).
+	 * @return Returns false if a field is invalid.
+	 */
+        static bool readObservables(const std::string& line, double& C1, double& L1, double& C2, double& L2, int& lliL1);
+	
+	//!Function to close last epoch left open by @ref readRecords, zero padding satellites without values.
+        void closeEpoch();
+	
+	//!Function to set epoch filter applied while reading.
+        /*!Epochs out of [start, end) or not on decimation grid are skipped by @ref read
+	 * at line level, together with their satellite lines. Must be called before @ref read.
+	 * @param start Window start, GPS time (UNIX-style seconds).
+	 * @param end Window end (exclusive), GPS time (UNIX-style seconds).
+	 * @param decimationSeconds Interval of kept epochs in seconds, 0 keeps all epochs.
+	 * @param offsetSeconds Kept epochs are at multiples of decimationSeconds plus this offset.
+	 */
+        void setEpochFilter(long long start, long long end, int decimationSeconds, int offsetSeconds);
+	
+	
+	//!Function to set out-lier levelling filter.
+        /*!Out-liers found by @ref processArc are replaced by Savitzky-Golay estimate from 
+	 * neighbouring epochs (see @ref savitzkyGolay), default half window 3 and order 1.
+	 * \param halfWindow Number of epochs on each side of out-lier.
+	 * \param order Order of polynomial fitted to neighbouring epochs.
+	 */
+        void setSmoothing(int halfWindow, int order);
+	
+	
+	//!Function to set carrier smoothing of code-derived TEC.
+        /*!Code-derived TEC (from C1/C2) of each arc is smoothed by @ref processArc with a Hatch 
+	 * filter into @ref codeTEC, used by @ref levelArcs. Default 0, code is not smoothed.
+	 * \param windowSeconds Hatch filter window (seconds), 0 to disable.
+	 */
+        void setHatchFilter(int windowSeconds);
+	
 	//!Constructor with Input files, and system string
         /*!Constructs observation object by seting input observation file name 
 	 * vector @ref fnames given file names and setting system flags given system string.
@@ -81,32 +150,124 @@ class ObsData
 	
 	
 	
+	//!Function to compute satellite elevations.
+        /*!This function computes elevation series (@ref satElevation) for all satellites
+	 * having data, at epochs where observations are present, using satellite positions 
+	 * from navigation data and @ref geometry batches.
+	 * @param nav Navigation data.
+	 * @param rh Ionosphere reference height in Kilometers.
+	 * @param from First epoch to compute, earlier elevations are kept.
+	 * @param to Epoch after last one to compute, -1 for all epochs.
+	 */
+        void setElevations(navigation& nav, int rh, int from = 0, int to = -1);
+	
+	
+	
 	//!Function to perform preprocessing.
-        /*!This function performs preprocessing by filling gaps using lagrange
-	 * interpolation and removing phase jumps using quartiles and Inter Quartile Range.
-	 * @param minArcLen minimum data duration(Seconds) to consider an arc valid.
+        /*!This function performs preprocessing by cutting data out of elevation mask, filling 
+	 * gaps using lagrange interpolation and removing phase jumps using quartiles and Inter 
+	 * Quartile Range. Elevation mask is applied only if @ref setElevations was called.
+	 * All epochs read are preprocessed, data not needed should be left out by @ref setEpochFilter.
+	 * @param minArcLen minimum data duration(Minutes) to consider an arc valid.
 	 * @param intrpolIntrvl Maximum gap duration (Seconds) to interpolate.
-	 * @param deg Degree of Interpolation, passed to @ref lagrangeInterpolation.
+	 * @param deg Degree of Interpolation, passed to @ref fillGap.
+	 * @param minElevation Minimum satellite elevation (degrees).
+	 * @param maxElevation Maximum satellite elevation (degrees).
 	 */
-        void pre_process(int minArcLen, int intrpolIntrvl, int deg);
+        void pre_process(int minArcLen, int intrpolIntrvl, int deg, float minElevation, float maxElevation);
 	
 	
 	
+	//!Function to level phase arcs to code.
+        /*!This function adds to each processed arc of @ref arcs, not yet levelled, the mean difference
+	 * between code-derived TEC (from C1/C2, or @ref codeTEC if Hatch filter is enabled) and phase TEC, weighted by squared sine of elevation 
+	 * (@ref satElevation, equal weights if not computed). Level is kept in arcTable::level, and arc
+	 * is flagged arcTable::LEVELLED. Arcs without code are left as they are.
+	 */
+        void levelArcs();
+	
+	
 	//!Function to perform Arc Marking.
         /*!This function performs arc marking considering minimum lenght of arc 
-	 * and minimum data rejection from arc start/end.
-	 * @param rejHours Hours of data to reject from start and end of arc.
+	 * and minimum data rejection from arc start/end. Rejected hours are counted from
+	 * epoch window of @ref setEpochFilter (or from first and last epoch without window),
+	 * so that missing data at window ends does not shift the solution window.
+	 * @param rejHours Hours of data to reject from start and end of epoch window.
 	 * @param minArcHours Hours of data considered minimum for an arc.
 	 */
          void markArcStartEnd(int& rejHours, int& minArcHours);
+	 
+	 
+	//!Function to preprocess arcs closed since last call.
+        /*!Incremental counterpart of @ref pre_process and @ref markArcStartEnd for an observation
+	 * file still being written. For each satellite, a data segment is closed once it is followed 
+	 * by a gap longer than intrpolIntrvl. Closed segments are cut by elevation mask, gap filled and 
+	 * levelled like in @ref pre_process, and added to @ref arcs as solution arcs.
+	 * @param nav Navigation data.
+	 * @param rh Ionosphere reference height in Kilometers.
+	 * @param minArcLen minimum data duration(Minutes) to consider an arc valid.
+	 * @param intrpolIntrvl Maximum gap duration (Seconds) to interpolate.
+	 * @param deg Degree of Interpolation, passed to @ref fillGap.
+	 * @param minElevation Minimum satellite elevation (degrees).
+	 * @param maxElevation Maximum satellite elevation (degrees).
+	 * @param firstEpoch Output first epoch index of new arcs.
+	 * @param lastEpoch Output last epoch index of new arcs.
+	 * @param flush Whether data is complete, so that last epoch and open segments are closed.
+	 * @return Returns number of new arcs.
+	 */
+        int processClosedArcs(navigation& nav, int rh, int minArcLen, int intrpolIntrvl, int deg,
+                              float minElevation, float maxElevation, int& firstEpoch, int& lastEpoch, bool flush = false);
 
 	
 	
         void dumpNonZeroArcs();
 	
+	//! Gets series of a satellite.
+        /*! This function maps an index as in @ref NonZero_Mark to satellite system,
+	 *  prn and its raw non-calibrated TEC vector.
+	 *  @param index Satellite index [0-119].
+	 *  @param sys Output satellite system ('G','R','E','C').
+	 *  @param prn Output satellite prn.
+	 *  @return Pointer to raw non-calibrated TEC vector of the satellite.
+	 */
+        std::vector<float>* satSeries(int index, char& sys, int& prn);
+	
 	
         int dumpArcBinaryPtrsAll();
         int dumpArcValuePtrsAll();
+	
+	
+	//!Function to write quality metrics of arcs.
+        /*!Writes one CSV line for each row of @ref arcs: system, prn, GPS time (seconds) of first and
+	 * last epoch, epochs, gaps filled, fraction of epochs interpolated, out-liers levelled, standard
+	 * deviation of rate of TEC over arc (TECU/min), RMS of first differences (TECU) and code level (TECU). File is written under a 
+	 * temporary name and renamed, so that readers never see it partially written.
+	 * \param fileName Output file name.
+	 * \return Returns false if file could not be written.
+	 */
+        bool writeArcQuality(const std::string& fileName);
+	
+	
+	//!Function to compute rate of TEC and ROTI.
+        /*!Fills @ref rot and @ref roti for epochs of processed arcs of @ref arcs not done yet, so that
+	 * in real-time mode only newly closed arcs are computed. ROTI at an epoch is standard deviation 
+	 * of rate of TEC over window ending at that epoch, defined when all epochs of window are valid.
+	 * It is computed from prefix sums of rate and squared rate, so that each epoch is a difference
+	 * of two sums whatever window length, in a loop without dependencies between epochs.
+	 * \param windowSeconds ROTI window (seconds).
+	 */
+        void computeROTI(int windowSeconds);
+	
+	
+	//!Function to write rate of TEC and ROTI.
+        /*!Binary file, native byte order: "ROTI", int32 epochs, int32 satellites (120), int32 window
+	 * (seconds), int64 time (GPS nanoseconds) of each epoch, then @ref rot and @ref roti as float32
+	 * epochs x satellites arrays (satellite index as @ref NonZero_Mark). File is written under a
+	 * temporary name and renamed.
+	 * \param fileName Output file name.
+	 * \return Returns false if file could not be written.
+	 */
+        bool writeROTI(const std::string& fileName);
 
 
         std::vector<std::string > fnames; //!< list of file names to read from
@@ -117,9 +278,25 @@ class ObsData
         
         triple MarkerPosition; //!< @ref triple Object to store receiver-station position
         
+        //! Receiver-station ellipsoidal position.
+        /*! Latitude, longitude (degrees) and height of @ref MarkerPosition, computed
+         *  once after reading observation files.
+         */
+        triple MarkerEllipsoidal;
+        
         float version; //!< Stores RINEX version of observation files
 	
-        int interval; //!< Interval between observations in data file
+        //! Interval between observations in nanoseconds.
+        /*! Taken from observation Header, or from first two epochs when Header has no interval.
+         */
+        long long interval;
+        
+        long long windowStart; //!< Start of epoch window (nanoseconds), see @ref setEpochFilter
+        long long windowEnd; //!< End of epoch window (nanoseconds), see @ref setEpochFilter
+        long long decimation; //!< Interval of kept epochs (nanoseconds), 0 keeps all epochs
+        long long decimationOffset; //!< Offset of kept epochs from multiples of @ref decimation (nanoseconds)
+        savitzkyGolay outlierFilter; //!< Estimate replacing out-liers in @ref processArc, see @ref setSmoothing
+        int hatchWindow; //!< Hatch filter window (seconds) of code-derived TEC, 0 if disabled, see @ref setHatchFilter
 
         // Flags to indicate whether Data file contains a constellation
         bool hasGPS; //!< Flag to indicate whether Data file contains GPS Data
@@ -143,7 +320,7 @@ class ObsData
         
         internalTime TOFO; //!< @ref internalTime Object to store Time of first observation
 
-        std::vector<int> timeline_main;  //!< Integer vector to store epochs in UNIX time
+        std::vector<long long> timeline_main;  //!< Integer vector to store epochs in GPS time (UNIX-style nanoseconds)
         
         //! Vectors to store raw non-calibrated TEC for GPS Satellites. 
         /*! This is a Vector of float-vectors, where first index is the Satellite prn-id
@@ -191,18 +368,13 @@ class ObsData
         int istart; //!< Indicates arc start index after rejected data.
         int iend; //!< Indicates arc end index after rejected data.
         
-        std::vector<int_pair > intse;
-	
 	//! Indicates total number of arcs.
-        /*! Indicates total number of arcs formed. Arc numbers are defined by pre_processing phase
-	 *  using @ref pre_process.
+        /*! Indicates total number of arcs formed. Arc numbers (rows of @ref arcs) are defined by 
+	 *  @ref markArcStartEnd or @ref processClosedArcs.
 	 */
         int numArcs;
         
 
-	std::vector<int> prnid;
-        
-
         int GPS_Mark[32];
         int GLO_Mark[24];
         int GAL_Mark[30];
@@ -211,25 +383,52 @@ class ObsData
         int NonZero_Mark[120];
         int numNonZeroArcs;
         
-	
-	//! Initial non-zero arc pinters.
-        /*! @ref ptr_pair Object containing Initial non-zero arcs, without preprocessing
-	 *  being applied.
+        //! Satellite elevation series.
+        /*! Elevation (degrees) for each satellite, indexed as @ref NonZero_Mark, and for each
+	 *  epoch as @ref timeline_main. Elevation is NaN where there is no observation or
+	 *  no ephemeris, vectors are empty for satellites without data.
 	 */
-        std::vector<ptr_pair> arcs;
-	
-	//! Arc pointers without zeros
-        /*! @ref ptr_pair Object containing arcs, without leading and trailing zeros.
+        std::vector< std::vector<float> > satElevation;
+        
+        //! Raw observables per satellite.
+        /*! Code, wide-lane phase and loss of lock flags for each satellite, indexed as @ref NonZero_Mark,
+	 *  and for each epoch as @ref timeline_main (zero where satellite has no observation).
+	 *  Used by cycle slip detection (@ref findSlips).
+	 */
+        std::vector< std::vector<double> > code1;    //!< C1 pseudorange (meters)
+        std::vector< std::vector<double> > code2;    //!< C2 pseudorange (meters)
+        
+        //! Carrier smoothed code-derived TEC (TECU) per satellite.
+        /*! Indexed as @ref NonZero_Mark, with a value for each epoch as @ref timeline_main, NaN where
+	 *  not defined. Filled for processed arcs by @ref hatchFilter, empty if Hatch filter is disabled.
+	 */
+        std::vector< std::vector<float> > codeTEC;
+        std::vector< std::vector<double> > wideLane; //!< L1 - L2 phase (wide-lane cycles)
+        std::vector< std::vector<unsigned char> > lossOfLock; //!< Loss of lock indicator of L1 phase
+        
+        //! Validity of raw non-calibrated TEC per satellite.
+        /*! @ref epochMask for each satellite, indexed as @ref NonZero_Mark, with a bit for each epoch
+	 *  as @ref timeline_main. Set at parse time where satellite has a value, cleared by elevation mask
+	 *  and at cycle slips, set again where gaps are filled. Arcs and gaps are found on these bits,
+	 *  so a value of 0.0 is a valid value.
 	 */
-        std::vector<ptr_pair> arcs2;
+        std::vector<epochMask> validEpochs;
+        
+        int streamFrom[120]; //!< First epoch not yet in a closed arc, for each satellite (see @ref processClosedArcs)
+        int elevationEpochs; //!< Number of epochs with elevation mask applied (see @ref processClosedArcs)
         
-        //! Arc pointers without gaps
-        /*! @ref ptr_pair Object containing arcs, with gaps removoed by 
-	 *  @ref lagrangeInterpolation and phase jumps removed. These are the processed 
-	 *  Arcs.
-	 * 
+        std::vector<float> rot;  //!< Rate of TEC (TECU/min), epochs x 120 (row per epoch), NaN where not defined
+        std::vector<float> roti; //!< ROTI (TECU/min), epochs x 120 (row per epoch), NaN where not defined
+        int rotiWindow; //!< Window of @ref roti (seconds)
+        
+	
+	//! Arcs of all satellites.
+        /*! @ref arcTable Object, read and rewritten by each stage: one arc per satellite after 
+	 *  @ref setArcStartEnd, processed pieces (gaps removed by @ref fillGap and phase jumps 
+	 *  levelled) after @ref pre_process, and arcs entering the solution after 
+	 *  @ref markArcStartEnd or @ref processClosedArcs.
 	 */
-        std::vector<ptr_pair> arcs3;
+        arcTable arcs;
         
 
 
@@ -261,26 +460,119 @@ class ObsData
         void setSysFlags(std::string sysString);
 	
         int pad_zero(int);
+	
+	//! Checks whether an epoch (GPS time nanoseconds) passes time window and decimation.
+        bool keepEpoch(long long t);
         void resetMark();
         int pad_zero();
         void markNonZeroArcs(int, int);
         void getnumNonZeroArcs();
 	
-	//! Sets Arc pointers using @ref ptr_pair objects
-        /*! This function sets Arc pointers to start/end pairs using
-	 *  @ref ptr_pair, which serve as input arcs to preprocessing phase.
+	
+	//! Applies elevation mask.
+        /*! This function sets to zero all values of satellites whose elevation is
+	 *  out of [minElevation, maxElevation], values with unknown elevation are kept.
+	 *  @param minElevation Minimum satellite elevation (degrees).
+	 *  @param maxElevation Maximum satellite elevation (degrees).
+	 *  @param from First epoch to mask.
+	 *  @param to Epoch after last one to mask, -1 for all epochs.
+	 */
+        void applyElevationMask(float minElevation, float maxElevation, int from = 0, int to = -1);
+	
+	//! Sets initial arcs.
+        /*! This function sets one arc per satellite having data in @ref arcs, over all
+	 *  epochs read, which serve as input arcs to preprocessing phase.
 	 */
         void setArcStartEnd();
 	
-	//!Function to perform lagrange interpolation
-        /*!This function performs lagrange Interpolation needed in preprocessing phase, given a
-	 * required degree for interpolation.
-	 * @param target pointer to the value being interpolated.
-	 * @param s start pointer of the arc.
-	 * @param e end pointer of the arc.
+	//!Function to fill one gap by lagrange interpolation
+        /*!This function fills a run of missing epochs [gs, ge) of an arc by lagrange interpolation
+	 * of degree deg, using deg/2 valid values on each side of the gap (more from one side
+	 * if the other reaches arc start/end), and marks them valid in @ref validEpochs. Barycentric 
+	 * weights depend only on node offsets from the gap start, and are taken from a small 
+	 * per-thread cache keyed by those offsets.
+	 * @param index Satellite index [0-119].
+	 * @param gs first epoch of the gap.
+	 * @param ge epoch after last one of the gap.
+	 * @param s first epoch of the arc.
+	 * @param e epoch after last one of the arc.
 	 * @param deg degree of Interpolation.
+	 * @return 0 on success, negative if degree is invalid or arc has not enough points.
 	 */
-        int lagrangeInterpolation(float* target, float* s, float* e, int deg);
+        int fillGap(int index, int gs, int ge, int s, int e, int deg);
+	
+	//! Smooths code-derived TEC of one arc with phase (Hatch filter).
+        /*! Smoothed value is phase TEC plus running mean of code minus phase TEC, over last 
+	 *  @ref hatchWindow seconds of epochs having code, computed recursively in one pass with
+	 *  constant memory. Epochs without code carry the value forward with phase. Filter restarts
+	 *  after an epoch without valid phase. Output goes to @ref codeTEC.
+	 *  @param index Satellite index [0-119].
+	 *  @param from first epoch of the arc.
+	 *  @param to epoch after last one of the arc.
+	 */
+        void hatchFilter(int index, int from, int to);
+	
+	//! Preprocesses one arc.
+        /*! This function fills gaps of an arc using @ref fillGap and levels
+	 *  phase jumps found by quartiles and Inter Quartile Range of first differences,
+	 *  replacing them by estimate of @ref outlierFilter. Quality metrics of the arc (gaps and
+	 *  out-liers counted on the way, first differences in one pass over levelled arc) are returned.
+	 *  @param index Satellite index [0-119].
+	 *  @param from first epoch of the arc.
+	 *  @param to epoch after last one of the arc.
+	 *  @param deg degree of Interpolation.
+	 *  @param quality Output quality metrics of the arc.
+	 */
+        void processArc(int index, int from, int to, int deg, arcQuality& quality);
+	
+	//! Preprocesses one arc through all steps.
+        /*! This function trims missing epochs at arc ends, cuts arc at gaps longer than maxGap, splits pieces 
+	 *  at cycle slips (@ref splitAtSlips) and runs @ref processArc on each piece. It only touches 
+	 *  memory of its own arc, so arcs are processed in parallel by @ref pre_process.
+	 *  @param index Satellite index [0-119].
+	 *  @param from first epoch of the arc, as set by @ref setArcStartEnd.
+	 *  @param to epoch after last one of the arc.
+	 *  @param minEpochs Minimum number of epochs of a piece.
+	 *  @param maxGap Maximum gap (nanoseconds) to interpolate.
+	 *  @param deg degree of Interpolation.
+	 *  @param pieces Output processed pieces (start, end epochs), appended in time order.
+	 *  @param quality Output quality metrics, one for each piece.
+	 */
+        void preprocessArc(int index, int from, int to, int minEpochs, long long maxGap, int deg, std::vector<int_pair>& pieces,
+                           std::vector<arcQuality>& quality);
+	
+	//! Finds cycle slips of a satellite.
+        /*! This function flags an epoch as cycle slip when loss of lock is set on L1, when geometry-free 
+	 *  phase second difference exceeds GF_SLIP_TECU, or when Melbourne-Wubbena combination departs
+	 *  from its running mean (since last slip) by more than MW_SLIP_SIGMAS standard deviations 
+	 *  (at least MW_SLIP_MIN wide-lane cycles). First epoch is never a slip.
+	 *  @param index Satellite index [0-119].
+	 *  @param from First epoch.
+	 *  @param to Epoch after last one.
+	 *  @param slips Output epochs of slips, appended in increasing order.
+	 */
+        void findSlips(int index, int from, int to, std::vector<int>& slips);
+	
+	//! Splits an arc at cycle slips.
+        /*! This function splits an arc at slips found by @ref findSlips. Epoch of each slip is marked
+	 *  missing (and zeroed), so that split is kept by @ref markArcStartEnd. Pieces are trimmed of
+	 *  missing epochs, and kept only if they have at least minEpochs epochs.
+	 *  @param index Satellite index [0-119].
+	 *  @param from first epoch of the arc.
+	 *  @param to epoch after last one of the arc.
+	 *  @param minEpochs Minimum number of epochs of a piece.
+	 *  @param pieces Output pieces (start, end epochs), appended.
+	 */
+        void splitAtSlips(int index, int from, int to, int minEpochs, std::vector<int_pair>& pieces);
+	
+	//! Appends raw observables of satellite index for current epoch, valid if both phases are present.
+        void pushObservables(int index, double C1, double C2, double L1, double L2, int lli);
+	
+	//! Appends zero observables of satellite index for current epoch.
+        void padObservables(int index);
+	
+	//! Sets @ref interval from first two epochs if Header had none, returns false if unknown.
+        bool setInterval();
 
 };
 
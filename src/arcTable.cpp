@@ -0,0 +1,128 @@
+/*
+    GTEC -  A high performance standardized implementation of 
+    Multi Constellation GNSS Derived TEC Calibration 
+    (Model by T/ICT4D Lab ICTP).
+    Copyright (C) 2016,2017  Muhammad Owais
+    
+    This file is part of GTEC.
+
+    GTEC is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    GTEC is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with GTEC.  If not, see <http://www.gnu.org/licenses/>.
+    
+    Disclaimer: GTEC is a research implementation which is under 
+    development and should not be considered fully functional unless 
+    otherwise stated or a release is announced. Author is providing this 
+    software on a best effort AS IS basis and do not warrant validity, 
+    functionality, and suitability for any particular purpose. All copyright 
+    notices must be kept intact. 
+
+*/
+
+
+
+#include "arcTable.hpp"
+#include "constants.hpp"
+#include <algorithm>
+
+
+int arcTable::add(int satellite, int first, int last, unsigned char flags)
+{
+    //rows are mostly added in order, so position is searched from the end
+    int j = sat.size();
+    while(j > 0 && (sat[j - 1] > satellite || (sat[j - 1] == satellite && start[j - 1] > first)))
+        {
+            j -= 1;
+        }
+
+    char sys;
+    if(satellite < GPS_SIZE)
+        sys = 'G';
+    else if(satellite < GPS_SIZE + GLO_SIZE)
+        sys = 'R';
+    else if(satellite < GPS_SIZE + GLO_SIZE + GAL_SIZE)
+        sys = 'E';
+    else
+        sys = 'C';
+
+    sat.insert(sat.begin() + j, satellite);
+    system.insert(system.begin() + j, sys);
+    start.insert(start.begin() + j, first);
+    end.insert(end.begin() + j, last);
+    level.insert(level.begin() + j, 0.0f);
+    this->flags.insert(this->flags.begin() + j, flags);
+    gaps.insert(gaps.begin() + j, 0);
+    filled.insert(filled.begin() + j, 0);
+    outliers.insert(outliers.begin() + j, 0);
+    fdRms.insert(fdRms.begin() + j, 0.0f);
+    rotStd.insert(rotStd.begin() + j, 0.0f);
+    return j;
+};
+
+int arcTable::size() const
+{
+    return sat.size();
+};
+
+int arcTable::length(int j) const
+{
+    return end[j] - start[j];
+};
+
+int arcTable::prn(int j) const
+{
+    switch(system[j])
+        {
+        case 'G':
+            return sat[j] + 1;
+        case 'R':
+            return sat[j] - GPS_SIZE + 1;
+        case 'E':
+            return sat[j] - GPS_SIZE - GLO_SIZE + 1;
+        default:
+            return sat[j] - GPS_SIZE - GLO_SIZE - GAL_SIZE + 1;
+        }
+};
+
+void arcTable::clear()
+{
+    sat.clear();
+    system.clear();
+    start.clear();
+    end.clear();
+    level.clear();
+    flags.clear();
+    gaps.clear();
+    filled.clear();
+    outliers.clear();
+    fdRms.clear();
+    rotStd.clear();
+};
+
+void arcTable::setQuality(int j, const arcQuality& q)
+{
+    gaps[j] = q.gaps;
+    filled[j] = q.filled;
+    outliers[j] = q.outliers;
+    fdRms[j] = q.fdRms;
+    rotStd[j] = q.rotStd;
+};
+
+arcQuality arcTable::quality(int j) const
+{
+    arcQuality q;
+    q.gaps = gaps[j];
+    q.filled = filled[j];
+    q.outliers = outliers[j];
+    q.fdRms = fdRms[j];
+    q.rotStd = rotStd[j];
+    return q;
+};
@@ -0,0 +1,119 @@
+/*
+    GTEC -  A high performance standardized implementation of 
+    Multi Constellation GNSS Derived TEC Calibration 
+    (Model by T/ICT4D Lab ICTP).
+    Copyright (C) 2016,2017  Muhammad Owais
+    
+    This file is part of GTEC.
+
+    GTEC is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    GTEC is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with GTEC.  If not, see <http://www.gnu.org/licenses/>.
+    
+    Disclaimer: GTEC is a research implementation which is under 
+    development and should not be considered fully functional unless 
+    otherwise stated or a release is announced. Author is providing this 
+    software on a best effort AS IS basis and do not warrant validity, 
+    functionality, and suitability for any particular purpose. All copyright 
+    notices must be kept intact. 
+
+*/
+
+
+
+
+
+#ifndef __ARC_TABLE__
+#define __ARC_TABLE__
+
+#include <vector>
+
+
+//! Quality metrics of an arc (see ObsData::processArc)
+struct arcQuality
+{
+    int gaps;     //!< Number of gaps filled by interpolation
+    int filled;   //!< Number of epochs filled by interpolation
+    int outliers; //!< Number of out-liers levelled
+    float fdRms;  //!< RMS of first differences (TECU)
+    float rotStd; //!< Standard deviation of rate of TEC over whole arc (TECU/min)
+};
+
+
+/**
+ * @class arcTable
+ * @author Muhammad Owais
+ * @date 19/10/26
+ * @file arcTable.hpp
+ * @brief Class defining table of arcs.
+ * 
+ * This Class Defines arcs of all satellites as a table with one column per
+ * attribute (structure of arrays). Arcs refer to data by satellite index and
+ * epoch indices, not by pointers, so the table stays valid when data vectors
+ * grow, and passes over one attribute of all arcs read contiguous memory.
+ * Rows are kept ordered by satellite and start epoch.
+ */
+class arcTable
+{
+  public:
+
+    //! Arc flags
+    enum flag
+    {
+        PROCESSED = 1, //!< Gaps filled and outliers levelled
+        SOLUTION = 2,  //!< Arc enters the calibration system (see ObsData::markArcStartEnd)
+        LEVELLED = 4,  //!< Arc levelled to code (see ObsData::levelArcs)
+        ROTI = 8       //!< Rate of TEC and ROTI computed (see ObsData::computeROTI)
+    };
+
+    //!Function to add an arc.
+    /*!Arc is inserted after arcs of lower satellite index, or of same satellite and 
+     * not later start epoch.
+     * \param satellite Satellite index [0-119] (as ObsData::NonZero_Mark).
+     * \param first First epoch of arc.
+     * \param last Epoch after last one of arc.
+     * \param flags Arc flags.
+     * \return Returns row of added arc.
+     */
+    int add(int satellite, int first, int last, unsigned char flags);
+
+    //!Function to get number of arcs.
+    int size() const;
+
+    //!Function to get number of epochs of arc j.
+    int length(int j) const;
+
+    //!Function to get prn of arc j satellite.
+    int prn(int j) const;
+
+    //!Function to remove all arcs.
+    void clear();
+
+    //!Function to set quality metrics of arc j.
+    void setQuality(int j, const arcQuality& q);
+
+    //!Function to get quality metrics of arc j.
+    arcQuality quality(int j) const;
+
+    std::vector<int> sat;      //!< Satellite index [0-119]
+    std::vector<char> system;  //!< Satellite system ('G','R','E','C')
+    std::vector<int> start;    //!< First epoch (index in ObsData::timeline_main)
+    std::vector<int> end;      //!< Epoch after last one
+    std::vector<float> level;  //!< Level (TECU) added to arc values, 0 if not levelled
+    std::vector<unsigned char> flags; //!< Combination of @ref flag values
+    std::vector<int> gaps;     //!< Quality: gaps filled (see @ref arcQuality)
+    std::vector<int> filled;   //!< Quality: epochs filled
+    std::vector<int> outliers; //!< Quality: out-liers levelled
+    std::vector<float> fdRms;  //!< Quality: RMS of first differences (TECU)
+    std::vector<float> rotStd; //!< Quality: standard deviation of rate of TEC over arc (TECU/min)
+};
+
+#endif
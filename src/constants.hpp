@@ -80,6 +80,19 @@ const double Blmda1 = 1.0 / BDU_f1;
 const double Blmda2 = 1.0 / BDU_f2;
 
 
+//Cycle slip detection thresholds
+const double MW_SLIP_SIGMAS = 4.0; //Melbourne-Wubbena jump, in standard deviations of its running mean
+const double MW_SLIP_MIN = 2.0;    //Minimum Melbourne-Wubbena jump (wide-lane cycles)
+const double GF_SLIP_TECU = 1.0;   //Geometry-free phase second difference (TECU)
+
+//Gap interpolation
+const int MAX_INTERPOLATION_DEGREE = 16; //Highest degree of lagrange interpolation (DEGREE)
+const int LAGRANGE_CACHE_SIZE = 16;      //Node patterns kept per thread for gap interpolation
+
+//Out-lier levelling (Savitzky-Golay estimate from neighbours)
+const int MAX_SG_HALF_WINDOW = 16; //Highest number of epochs on each side of out-lier (SGWINDOW)
+const int MAX_SG_ORDER = 4;        //Highest order of fitted polynomial (SGORDER)
+
 const double mu = 3.986005e+14;
 const double mu_WGS84 = 3.986004418e+14;
 const double wE = 7.2921150e-05;  //Earth's rotation rate in radians per sec.
@@ -90,6 +103,9 @@ const double a_WGS84 = 6378137.0;
 //Polar radius of earth elipsoid in meters (semi-minor axis)
 const double b_WGS84 = 6356752.314245;
 
+//Mean radius of earth in meters (spherical ionosphere shell)
+const double Re_mean = 6371000.0;
+
 
 //////////////////////////// PZ-90 Constants ///////////////////////////////////
 // Reference: http://www.navipedia.net/index.php/GLONASS_Satellite_Coordinates_Computation
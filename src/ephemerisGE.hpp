@@ -41,7 +41,7 @@
 class ephemerisGE
 {
     public:
-        int Toc;        //Time of clock (GPS/GAL) converted to UNIX time
+        long long Toc;  //Time of clock converted to GPS time (UNIX-style seconds)
         int Toe;        //Ephemeris reference epoch in seconds with in GPS/GAL week
         int week;       //GPS/GAL week # (to go with Toe)   
         float Ahalf;    //Square root of semi-major axis 
@@ -39,7 +39,7 @@
 class ephemerisR
 {
     public:
-        int tb;     //Ephemerides reference epoch 
+        long long tb; //Ephemerides reference epoch, converted from UTC to GPS time
         
         float px;   //Coordinate at te, in PZ-90 
         float py;   //Coordinate at te, in PZ-90
@@ -0,0 +1,306 @@
+/*
+    GTEC -  A high performance standardized implementation of 
+    Multi Constellation GNSS Derived TEC Calibration 
+    (Model by T/ICT4D Lab ICTP).
+    Copyright (C) 2016,2017  Muhammad Owais
+    
+    This file is part of GTEC.
+
+    GTEC is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    GTEC is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with GTEC.  If not, see <http://www.gnu.org/licenses/>.
+    
+    Disclaimer: GTEC is a research implementation which is under 
+    development and should not be considered fully functional unless 
+    otherwise stated or a release is announced. Author is providing this 
+    software on a best effort AS IS basis and do not warrant validity, 
+    functionality, and suitability for any particular purpose. All copyright 
+    notices must be kept intact. 
+
+*/
+
+
+#include <iostream>
+#include <string>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <cctype>
+#include <fstream>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "ephemerisStore.hpp"
+#include "navigation.hpp"
+#include "constants.hpp"
+
+static const char storeMagic[8] = { 'G', 'T', 'E', 'C', 'E', 'P', 'H', '\0' };
+static const int storeFormat = 3;
+static const int storeSats = GPS_SIZE + GLO_SIZE + GAL_SIZE + BDU_SIZE;
+
+
+
+ephemerisStore::ephemerisStore(const std::string& fname)
+{
+    fileName = fname;
+    data = NULL;
+    dataSize = 0;
+    counts = NULL;
+    records = NULL;
+};
+
+
+
+ephemerisStore::~ephemerisStore()
+{
+    if(data != NULL)
+        munmap((void*)data, dataSize);
+};
+
+
+
+bool ephemerisStore::open()
+{
+    int fd = ::open(fileName.c_str(), O_RDONLY);
+    if(fd < 0)
+        return false;
+
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size < (long long)sizeof(storeHeader)) {
+        close(fd);
+        return false;
+    }
+
+    void* map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(map == MAP_FAILED)
+        return false;
+
+    data = (const char*)map;
+    dataSize = st.st_size;
+
+    // validate layout, a store written by a different build is simply rebuilt
+    const storeHeader* header = (const storeHeader*)data;
+    long long offset = sizeof(storeHeader);
+    bool valid = memcmp(header->magic, storeMagic, sizeof(storeMagic)) == 0 &&
+                 header->format == storeFormat &&
+                 header->sizeGE == (int)sizeof(ephemerisGE) &&
+                 header->sizeR == (int)sizeof(ephemerisR) &&
+                 header->numSats == storeSats &&
+                 header->numSources >= 0;
+
+    if(valid) {
+        offset += (long long)header->numSources * sizeof(storeSource) + storeSats * sizeof(int);
+        valid = offset <= dataSize;
+    }
+
+    long long total = 0;
+    if(valid) {
+        const storeSource* src = (const storeSource*)(data + sizeof(storeHeader));
+        sources.assign(src, src + header->numSources);
+        counts = (const int*)(src + header->numSources);
+        records = data + offset;
+
+        for(int i = 0; i < storeSats; ++i) {
+            if(counts[i] < 0)
+                valid = false;
+            if(i >= GPS_SIZE && i < GPS_SIZE + GLO_SIZE)
+                total += (long long)counts[i] * sizeof(ephemerisR);
+            else
+                total += (long long)counts[i] * sizeof(ephemerisGE);
+        }
+        valid = valid && offset + total == dataSize;
+    }
+
+    if(!valid) {
+        munmap((void*)data, dataSize);
+        data = NULL;
+        dataSize = 0;
+        counts = NULL;
+        records = NULL;
+        sources.clear();
+        return false;
+    }
+    return true;
+};
+
+
+
+bool ephemerisStore::hasSource(const std::string& fname) const
+{
+    storeSource source;
+    if(!sourceInfo(fname, source))
+        return false;
+
+    for(const storeSource& s : sources) {
+        if(strncmp(s.name, source.name, sizeof(s.name)) == 0 && s.size == source.size && s.mtime == source.mtime)
+            return true;
+    }
+    return false;
+};
+
+
+
+bool ephemerisStore::hasChangedSource(const std::string& fname) const
+{
+    storeSource source;
+    if(!sourceInfo(fname, source))
+        return false;
+
+    for(const storeSource& s : sources) {
+        if(strncmp(s.name, source.name, sizeof(s.name)) == 0)
+            return s.size != source.size || s.mtime != source.mtime;
+    }
+    return false;
+};
+
+
+
+// Appends count records of type T from p to each satellite vector of store
+template <typename T>
+static const char* loadRecords(const char* p, const int* counts, std::vector<std::vector<T> >& store)
+{
+    const T* rec = (const T*)p;
+    for(size_t prn = 0; prn < store.size(); ++prn) {
+        store[prn].insert(store[prn].end(), rec, rec + counts[prn]);
+        rec += counts[prn];
+    }
+    return (const char*)rec;
+}
+
+
+
+void ephemerisStore::load(navigation& nav) const
+{
+    if(data == NULL)
+        return;
+
+    const storeHeader* header = (const storeHeader*)data;
+    if(nav.version == 0.0)
+        nav.version = header->version;
+    if(nav.leapSeconds == 0)
+        nav.leapSeconds = header->leapSeconds;
+
+    const char* p = records;
+    p = loadRecords(p, counts, nav.ephemeris_G);
+    p = loadRecords(p, counts + GPS_SIZE, nav.ephemeris_R);
+    p = loadRecords(p, counts + GPS_SIZE + GLO_SIZE, nav.ephemeris_E);
+    p = loadRecords(p, counts + GPS_SIZE + GLO_SIZE + GAL_SIZE, nav.ephemeris_C);
+};
+
+
+
+std::string ephemerisStore::storeName(const std::string& navFile)
+{
+    std::string dir = ".";
+    std::string base = navFile;
+    size_t slash = navFile.find_last_of('/');
+    if(slash != std::string::npos) {
+        dir = navFile.substr(0, slash);
+        base = navFile.substr(slash + 1);
+    }
+
+    // RINEX 2 style name ssssDDDf.YYt keyed as YYDDD, otherwise by file name
+    std::string key = base;
+    if(base.size() >= 12 && base[8] == '.' && isdigit(base[4]) && isdigit(base[5]) && isdigit(base[6]) &&
+       isdigit(base[9]) && isdigit(base[10])) {
+        key = base.substr(9, 2) + base.substr(4, 3);
+    }
+
+    dir += "/navcache";
+    if(mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST)
+        return "";
+
+    return dir + "/" + key + ".eph";
+};
+
+
+
+bool ephemerisStore::sourceInfo(const std::string& fname, storeSource& source)
+{
+    struct stat st;
+    if(stat(fname.c_str(), &st) != 0)
+        return false;
+
+    size_t slash = fname.find_last_of('/');
+    std::string base = (slash == std::string::npos) ? fname : fname.substr(slash + 1);
+
+    memset(source.name, 0, sizeof(source.name));
+    strncpy(source.name, base.c_str(), sizeof(source.name) - 1);
+    source.size = st.st_size;
+    source.mtime = st.st_mtime;
+    return true;
+};
+
+
+
+// Writes records of all satellites of store, in satellite order
+template <typename T>
+static void writeRecords(std::ofstream& out, const std::vector<std::vector<T> >& store)
+{
+    for(const std::vector<T>& sat : store) {
+        if(sat.size() != 0)
+            out.write((const char*)sat.data(), sat.size() * sizeof(T));
+    }
+}
+
+template <typename T>
+static void writeCounts(std::vector<int>& counts, const std::vector<std::vector<T> >& store)
+{
+    for(const std::vector<T>& sat : store)
+        counts.push_back(sat.size());
+}
+
+
+
+bool ephemerisStore::write(const std::string& fname, const navigation& nav, const std::vector<storeSource>& sources)
+{
+    storeHeader header;
+    memcpy(header.magic, storeMagic, sizeof(storeMagic));
+    header.format = storeFormat;
+    header.sizeGE = sizeof(ephemerisGE);
+    header.sizeR = sizeof(ephemerisR);
+    header.numSources = sources.size();
+    header.numSats = storeSats;
+    header.leapSeconds = nav.leapSeconds;
+    header.version = nav.version;
+
+    std::vector<int> counts;
+    writeCounts(counts, nav.ephemeris_G);
+    writeCounts(counts, nav.ephemeris_R);
+    writeCounts(counts, nav.ephemeris_E);
+    writeCounts(counts, nav.ephemeris_C);
+
+    // temporary name unique to process, stations may be processed concurrently
+    std::string tmpName = fname + "." + std::to_string(getpid()) + ".tmp";
+    std::ofstream out(tmpName.c_str(), std::ios::binary | std::ios::trunc);
+    if(!out.is_open())
+        return false;
+
+    out.write((const char*)&header, sizeof(header));
+    if(sources.size() != 0)
+        out.write((const char*)sources.data(), sources.size() * sizeof(storeSource));
+    out.write((const char*)counts.data(), counts.size() * sizeof(int));
+    writeRecords(out, nav.ephemeris_G);
+    writeRecords(out, nav.ephemeris_R);
+    writeRecords(out, nav.ephemeris_E);
+    writeRecords(out, nav.ephemeris_C);
+    out.close();
+
+    if(out.fail() || rename(tmpName.c_str(), fname.c_str()) != 0) {
+        remove(tmpName.c_str());
+        return false;
+    }
+    return true;
+};
@@ -0,0 +1,168 @@
+/*
+    GTEC -  A high performance standardized implementation of 
+    Multi Constellation GNSS Derived TEC Calibration 
+    (Model by T/ICT4D Lab ICTP).
+    Copyright (C) 2016,2017  Muhammad Owais
+    
+    This file is part of GTEC.
+
+    GTEC is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    GTEC is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with GTEC.  If not, see <http://www.gnu.org/licenses/>.
+    
+    Disclaimer: GTEC is a research implementation which is under 
+    development and should not be considered fully functional unless 
+    otherwise stated or a release is announced. Author is providing this 
+    software on a best effort AS IS basis and do not warrant validity, 
+    functionality, and suitability for any particular purpose. All copyright 
+    notices must be kept intact. 
+
+*/
+
+
+
+
+
+#ifndef __EPHEMERIS_STORE__
+#define __EPHEMERIS_STORE__
+
+#include <string>
+#include <vector>
+
+class navigation;
+
+
+/**
+ * @class ephemerisStore
+ * @author Muhammad Owais
+ * @date 19/10/26
+ * @file ephemerisStore.hpp
+ * @brief Class defining binary daily ephemeris store.
+ * 
+ * This Class Defines a binary store of merged, de-duplicated and time sorted 
+ * ephemeris records of all constellations for one day of navigation files. 
+ * Stores are kept in "navcache" directory next to navigation files, one file per
+ * day (YYDDD.eph, from RINEX file name). Store is memory mapped when opened, and
+ * records are copied from mapping to @ref navigation structure without parsing.
+ * 
+ * A store also keeps list of navigation files (name, size and modification time) 
+ * merged into it, new files (e.g. hourly files arriving for the same day) are 
+ * parsed and merged, and store is written again. If a merged file has changed, 
+ * store of that day is rebuilt from its current files.
+ * 
+ * Store layout: @ref storeHeader, @ref storeSource list, number of records per 
+ * satellite (indexed as ObsData::NonZero_Mark), and records of GPS, GLONASS, 
+ * Galileo and BeiDou, each sorted by satellite and time.
+ */
+class ephemerisStore
+{
+  public:
+    
+    //! Header of store file.
+    struct storeHeader
+    {
+        char magic[8];       //!< File identifier "GTECEPH"
+        int format;          //!< Store format version
+        int sizeGE;          //!< Size of ephemerisGE record, checks layout
+        int sizeR;           //!< Size of ephemerisR record, checks layout
+        int numSources;      //!< Number of merged navigation files
+        int numSats;         //!< Number of satellite slots (120)
+        int leapSeconds;     //!< Leap seconds from navigation files
+        float version;       //!< RINEX version of navigation files
+    };
+    
+    //! Navigation file merged into store.
+    struct storeSource
+    {
+        char name[64];       //!< Navigation file name (without directory)
+        long long size;      //!< File size in bytes
+        long long mtime;     //!< File modification time (UNIX)
+    };
+    
+    //!Constructor with store file name
+    /*!Constructs store object for a store file, file is not opened.
+     * \param fname Store file name.
+     */
+    ephemerisStore(const std::string& fname);
+    
+    ~ephemerisStore(); //!< Destructor, unmaps store file.
+    
+    //!Function to open store file.
+    /*!This function memory maps the store file and validates its layout.
+     * \return Returns false if store file does not exist or is invalid.
+     */
+    bool open();
+    
+    //!Function to check whether a navigation file is merged in store.
+    /*!\param fname Navigation file name.
+     * \return Returns true if file with same name, size and modification time
+     * is merged in store.
+     */
+    bool hasSource(const std::string& fname) const;
+    
+    //!Function to check whether a merged navigation file has changed.
+    /*!\param fname Navigation file name.
+     * \return Returns true if file with same name is merged in store with 
+     * different size or modification time.
+     */
+    bool hasChangedSource(const std::string& fname) const;
+    
+    //!Function to load records from store.
+    /*!This function appends all records of the mapped store to navigation
+     * structure, records are not sorted or de-duplicated by this function.
+     * \param nav Navigation object to append records to.
+     */
+    void load(navigation& nav) const;
+    
+    std::string fileName; //!< Store file name
+    
+    std::vector<storeSource> sources; //!< Navigation files merged in store
+    
+    
+    //!Function to get store file name of a navigation file.
+    /*!Store is named by year and day of year from RINEX file name (ssssDDDf.YYt), 
+     * in "navcache" directory next to navigation file. Directory is created if needed.
+     * \param navFile Navigation file name.
+     * \return Returns store file name, or empty string if directory can not be created.
+     */
+    static std::string storeName(const std::string& navFile);
+    
+    //!Function to get source entry of a navigation file.
+    /*!\param fname Navigation file name.
+     * \param source Output source entry.
+     * \return Returns false if file does not exist.
+     */
+    static bool sourceInfo(const std::string& fname, storeSource& source);
+    
+    //!Function to write store file.
+    /*!This function writes all records of navigation structure to store file,
+     * file is written to a temporary file first and renamed, so that readers 
+     * never map a partial store.
+     * \param fname Store file name.
+     * \param nav Navigation object with sorted, de-duplicated records.
+     * \param sources Navigation files merged in nav.
+     * \return Returns false on write failure.
+     */
+    static bool write(const std::string& fname, const navigation& nav, const std::vector<storeSource>& sources);
+    
+  private:
+    
+    ephemerisStore(); //!< default hidden Constructor 
+    ephemerisStore(const ephemerisStore&); //!< hidden copy Constructor, mapping is owned
+    ephemerisStore& operator=(const ephemerisStore&); //!< hidden assignment
+    
+    const char* data;      //!< Mapped store
+    long long dataSize;    //!< Size of mapped store
+    const int* counts;     //!< Number of records per satellite in mapped store
+    const char* records;   //!< First record in mapped store
+};
+
+#endif
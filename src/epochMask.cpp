@@ -0,0 +1,161 @@
+/*
+    GTEC -  A high performance standardized implementation of 
+    Multi Constellation GNSS Derived TEC Calibration 
+    (Model by T/ICT4D Lab ICTP).
+    Copyright (C) 2016,2017  Muhammad Owais
+    
+    This file is part of GTEC.
+
+    GTEC is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    GTEC is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with GTEC.  If not, see <http://www.gnu.org/licenses/>.
+    
+    Disclaimer: GTEC is a research implementation which is under 
+    development and should not be considered fully functional unless 
+    otherwise stated or a release is announced. Author is providing this 
+    software on a best effort AS IS basis and do not warrant validity, 
+    functionality, and suitability for any particular purpose. All copyright 
+    notices must be kept intact. 
+
+*/
+
+
+
+#include "epochMask.hpp"
+#include <algorithm>
+
+
+epochMask::epochMask()
+{
+    bits = 0;
+};
+
+void epochMask::push(bool valid)
+{
+    if(bits % 64 == 0)
+        words.push_back(0);
+    if(valid)
+        words[bits / 64] |= uint64_t(1) << (bits % 64);
+    bits += 1;
+};
+
+void epochMask::set(int k)
+{
+    words[k / 64] |= uint64_t(1) << (k % 64);
+};
+
+void epochMask::reset(int k)
+{
+    words[k / 64] &= ~(uint64_t(1) << (k % 64));
+};
+
+bool epochMask::test(int k) const
+{
+    return k >= 0 && k < bits && ((words[k / 64] >> (k % 64)) & 1) != 0;
+};
+
+int epochMask::size() const
+{
+    return bits;
+};
+
+int epochMask::nextSet(int from, int to) const
+{
+    int end = std::min(to, bits);
+    if(from >= end)
+        return to;
+
+    //first word is masked below from, following words are taken whole
+    int w = from / 64;
+    uint64_t word = words[w] & (~uint64_t(0) << (from % 64));
+    while(true)
+        {
+            if(word != 0)
+                {
+                    int k = w * 64 + __builtin_ctzll(word);
+                    return (k < end) ? k : to;
+                }
+            w += 1;
+            if(w * 64 >= end)
+                return to;
+            word = words[w];
+        }
+};
+
+int epochMask::nextClear(int from, int to) const
+{
+    if(from >= to)
+        return to;
+    if(from >= bits)
+        return from;
+
+    //same as nextSet on inverted words, bits beyond size are clear
+    int w = from / 64;
+    uint64_t word = ~words[w] & (~uint64_t(0) << (from % 64));
+    while(true)
+        {
+            if(word != 0)
+                {
+                    int k = w * 64 + __builtin_ctzll(word);
+                    return std::min(k, to);
+                }
+            w += 1;
+            if(w * 64 >= to || w * 64 >= bits)
+                return std::min(std::max(w * 64, bits), to);
+            word = ~words[w];
+        }
+};
+
+int epochMask::lastSet(int from, int to) const
+{
+    int end = std::min(to, bits);
+    if(from >= end)
+        return from;
+
+    //last word is masked at end, previous words are taken whole
+    int w = (end - 1) / 64;
+    uint64_t word = words[w];
+    if(end % 64 != 0)
+        word &= ~(~uint64_t(0) << (end % 64));
+    while(true)
+        {
+            if(word != 0)
+                {
+                    int k = w * 64 + 63 - __builtin_clzll(word);
+                    return (k >= from) ? k + 1 : from;
+                }
+            if(w * 64 <= from)
+                return from;
+            w -= 1;
+            word = words[w];
+        }
+};
+
+int epochMask::count(int from, int to) const
+{
+    int end = std::min(to, bits);
+    int n = 0;
+    if(from >= end)
+        return 0;
+
+    int w = from / 64;
+    int last = (end - 1) / 64;
+    for(int i = w; i <= last; ++i)
+        {
+            uint64_t word = words[i];
+            if(i == w)
+                word &= ~uint64_t(0) << (from % 64);
+            if(i == last && end % 64 != 0)
+                word &= ~(~uint64_t(0) << (end % 64));
+            n += __builtin_popcountll(word);
+        }
+    return n;
+};
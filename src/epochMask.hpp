@@ -0,0 +1,98 @@
+/*
+    GTEC -  A high performance standardized implementation of 
+    Multi Constellation GNSS Derived TEC Calibration 
+    (Model by T/ICT4D Lab ICTP).
+    Copyright (C) 2016,2017  Muhammad Owais
+    
+    This file is part of GTEC.
+
+    GTEC is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    GTEC is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with GTEC.  If not, see <http://www.gnu.org/licenses/>.
+    
+    Disclaimer: GTEC is a research implementation which is under 
+    development and should not be considered fully functional unless 
+    otherwise stated or a release is announced. Author is providing this 
+    software on a best effort AS IS basis and do not warrant validity, 
+    functionality, and suitability for any particular purpose. All copyright 
+    notices must be kept intact. 
+
+*/
+
+
+
+
+
+#ifndef __EPOCH_MASK__
+#define __EPOCH_MASK__
+
+#include <vector>
+#include <cstdint>
+
+
+/**
+ * @class epochMask
+ * @author Muhammad Owais
+ * @date 19/10/26
+ * @file epochMask.hpp
+ * @brief Class defining validity bitset of a satellite over epochs.
+ * 
+ * This Class Defines a bitset with one bit per epoch (64 epochs per word), set
+ * where a satellite has a usable value. Runs of valid epochs (arcs) and gaps are
+ * found a word at a time using count-trailing-zeros, and valid epochs are counted
+ * using popcount, so that a value of 0.0 is never taken as missing data.
+ * Bits beyond @ref size are clear.
+ */
+class epochMask
+{
+  public:
+
+    epochMask();
+
+    //!Function to append one epoch.
+    /*!\param valid Whether epoch has a usable value.
+     */
+    void push(bool valid);
+
+    void set(int k);   //!< Marks epoch k valid
+    void reset(int k); //!< Marks epoch k missing
+    bool test(int k) const; //!< Returns whether epoch k is valid
+    int size() const; //!< Returns number of epochs
+
+    //!Function to find first valid epoch.
+    /*!\param from First epoch to look at.
+     * \param to Epoch after last one to look at.
+     * \return Returns first valid epoch in [from, to), or to if there is none.
+     */
+    int nextSet(int from, int to) const;
+
+    //!Function to find first missing epoch.
+    /*!\param from First epoch to look at.
+     * \param to Epoch after last one to look at.
+     * \return Returns first missing epoch in [from, to), or to if there is none.
+     */
+    int nextClear(int from, int to) const;
+
+    //!Function to find end of valid data.
+    /*!\param from First epoch to look at.
+     * \param to Epoch after last one to look at.
+     * \return Returns epoch after last valid one in [from, to), or from if there is none.
+     */
+    int lastSet(int from, int to) const;
+
+    //!Function to count valid epochs in [from, to).
+    int count(int from, int to) const;
+
+    std::vector<uint64_t> words; //!< Bits, epoch k is bit k % 64 of word k / 64
+    int bits; //!< Number of epochs
+};
+
+#endif
@@ -0,0 +1,194 @@
+/*
+    GTEC -  A high performance standardized implementation of 
+    Multi Constellation GNSS Derived TEC Calibration 
+    (Model by T/ICT4D Lab ICTP).
+    Copyright (C) 2016,2017  Muhammad Owais
+    
+    This file is part of GTEC.
+
+    GTEC is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    GTEC is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with GTEC.  If not, see <http://www.gnu.org/licenses/>.
+    
+    Disclaimer: GTEC is a research implementation which is under 
+    development and should not be considered fully functional unless 
+    otherwise stated or a release is announced. Author is providing this 
+    software on a best effort AS IS basis and do not warrant validity, 
+    functionality, and suitability for any particular purpose. All copyright 
+    notices must be kept intact. 
+
+*/
+
+
+
+#include "fieldParser.hpp"
+#include <cmath>
+
+
+//Exact powers of ten representable in double
+static const double pow10Table[23] = { 1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                       1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                       1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                                       1e18, 1e19, 1e20, 1e21, 1e22 };
+
+
+bool fieldParser::toDouble(const char* line, int len, int col, int width, double& value)
+{
+    int end = col + width;
+    if(end > len)
+        end = len;
+
+    int i = col;
+    value = 0.0;
+
+    //skip leading blanks, a field starting beyond the end of line is blank
+    while(i < end && line[i] == ' ')
+        ++i;
+    if(i >= end)
+        return true;
+
+    bool negative = false;
+    if(line[i] == '-' || line[i] == '+')
+    {
+        negative = (line[i] == '-');
+        ++i;
+    }
+
+    //accumulate mantissa digits as integer, count digits after decimal point
+    long long mantissa = 0;
+    int digits = 0;
+    int fraction = 0;
+    int dropped = 0;
+    bool point = false;
+    bool anyDigit = false;
+    for(; i < end; ++i)
+    {
+        char ch = line[i];
+        if(ch >= '0' && ch <= '9')
+        {
+            anyDigit = true;
+            if(digits < 18)
+            {
+                mantissa = mantissa * 10 + (ch - '0');
+                if(mantissa != 0)
+                    ++digits;
+                if(point)
+                    ++fraction;
+            }
+            else if(!point)
+            {
+                //more significant digits than we can hold, keep scale
+                ++dropped;
+            }
+        }
+        else if(ch == '.' && !point)
+        {
+            point = true;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    //a sign, a point or an exponent alone is not a number
+    if(!anyDigit)
+        return false;
+
+    //optional exponent, 'D' or 'E' (any case)
+    int exponent = 0;
+    if(i < end && (line[i] == 'D' || line[i] == 'd' || line[i] == 'E' || line[i] == 'e'))
+    {
+        ++i;
+        bool expNegative = false;
+        if(i < end && (line[i] == '-' || line[i] == '+'))
+        {
+            expNegative = (line[i] == '-');
+            ++i;
+        }
+        if(i == end || line[i] < '0' || line[i] > '9')
+            return false;
+        while(i < end && line[i] >= '0' && line[i] <= '9')
+        {
+            exponent = exponent * 10 + (line[i] - '0');
+            ++i;
+        }
+        if(expNegative)
+            exponent = -exponent;
+    }
+
+    //only trailing blanks allowed
+    while(i < end)
+    {
+        if(line[i] != ' ')
+            return false;
+        ++i;
+    }
+
+    int scale = exponent - fraction + dropped;
+    double v = double(mantissa);
+    if(scale < 0)
+    {
+        v = (-scale <= 22) ? v / pow10Table[-scale] : v * pow(10.0, scale);
+    }
+    else if(scale > 0)
+    {
+        v = (scale <= 22) ? v * pow10Table[scale] : v * pow(10.0, scale);
+    }
+
+    value = negative ? -v : v;
+    return true;
+};
+
+
+
+bool fieldParser::toInt(const char* line, int len, int col, int width, int& value)
+{
+    int end = col + width;
+    if(end > len)
+        end = len;
+
+    int i = col;
+    value = 0;
+
+    //skip leading blanks, a field starting beyond the end of line is blank
+    while(i < end && line[i] == ' ')
+        ++i;
+    if(i >= end)
+        return true;
+
+    bool negative = false;
+    if(line[i] == '-' || line[i] == '+')
+    {
+        negative = (line[i] == '-');
+        ++i;
+    }
+
+    int v = 0;
+    int start = i;
+    for(; i < end && line[i] >= '0' && line[i] <= '9'; ++i)
+    {
+        v = v * 10 + (line[i] - '0');
+    }
+    if(i == start)
+        return false;
+
+    //only trailing blanks allowed
+    while(i < end)
+    {
+        if(line[i] != ' ')
+            return false;
+        ++i;
+    }
+
+    value = negative ? -v : v;
+    return true;
+};
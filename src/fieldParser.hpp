@@ -0,0 +1,86 @@
+/*
+    GTEC -  A high performance standardized implementation of 
+    Multi Constellation GNSS Derived TEC Calibration 
+    (Model by T/ICT4D Lab ICTP).
+    Copyright (C) 2016,2017  Muhammad Owais
+    
+    This file is part of GTEC.
+
+    GTEC is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    GTEC is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with GTEC.  If not, see <http://www.gnu.org/licenses/>.
+    
+    Disclaimer: GTEC is a research implementation which is under 
+    development and should not be considered fully functional unless 
+    otherwise stated or a release is announced. Author is providing this 
+    software on a best effort AS IS basis and do not warrant validity, 
+    functionality, and suitability for any particular purpose. All copyright 
+    notices must be kept intact. 
+
+*/
+
+
+
+
+
+#ifndef __FIELD_PARSER__
+#define __FIELD_PARSER__
+
+
+/**
+ * @class fieldParser
+ * @author Muhammad Owais
+ * @date 19/10/26
+ * @file fieldParser.hpp
+ * @brief Class defining fixed-column field conversion.
+ * 
+ * This Class Defines conversion routines for fixed-column fields of RINEX
+ * files, e.g. navigation data records (4X,4D19.12) where numbers are not
+ * separated by blanks ("1.234D-05-2.1D+00"). Conversions work directly on
+ * the character buffer of a line and do not allocate. Both 'D' and 'E'
+ * exponent characters are accepted. A blank field converts to zero.
+ */
+class fieldParser
+{
+  public:
+
+    //!Function to convert a fixed-column floating point field.
+    /*!This function converts characters [col, col + width) to a double. Characters
+     * beyond the end of line (given by len) are treated as blanks.
+     * \param line pointer to first character of the line.
+     * \param len length of the line.
+     * \param col zero based column where field starts.
+     * \param width width of the field.
+     * \param value Output converted value.
+     * \return Returns false if field contains invalid characters.
+     */
+    static bool toDouble(const char* line, int len, int col, int width, double& value);
+
+
+
+    //!Function to convert a fixed-column integer field.
+    /*!This function converts characters [col, col + width) to an integer. Characters
+     * beyond the end of line (given by len) are treated as blanks.
+     * \param line pointer to first character of the line.
+     * \param len length of the line.
+     * \param col zero based column where field starts.
+     * \param width width of the field.
+     * \param value Output converted value.
+     * \return Returns false if field contains invalid characters.
+     */
+    static bool toInt(const char* line, int len, int col, int width, int& value);
+
+  private:
+
+    fieldParser(); //!< default hidden Constructor 
+};
+
+#endif
@@ -0,0 +1,123 @@
+/*
+    GTEC -  A high performance standardized implementation of 
+    Multi Constellation GNSS Derived TEC Calibration 
+    (Model by T/ICT4D Lab ICTP).
+    Copyright (C) 2016,2017  Muhammad Owais
+    
+    This file is part of GTEC.
+
+    GTEC is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    GTEC is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with GTEC.  If not, see <http://www.gnu.org/licenses/>.
+    
+    Disclaimer: GTEC is a research implementation which is under 
+    development and should not be considered fully functional unless 
+    otherwise stated or a release is announced. Author is providing this 
+    software on a best effort AS IS basis and do not warrant validity, 
+    functionality, and suitability for any particular purpose. All copyright 
+    notices must be kept intact. 
+
+*/
+
+
+
+#include "geometry.hpp"
+#include "constants.hpp"
+#include <cmath>
+
+
+geometry::geometry(const triple& markerECEF, const triple& markerEllip, const double& rhKm)
+{
+    mx = markerECEF.X;
+    my = markerECEF.Y;
+    mz = markerECEF.Z;
+
+    //ENU basis at station, as described in
+    //http://www.navipedia.net/index.php/Transformations_between_ECEF_and_ENU_coordinates
+    double phi = markerEllip.X * toRadians;
+    double lambda = markerEllip.Y * toRadians;
+
+    east[0] = -1 * sin(lambda);
+    east[1] = cos(lambda);
+    east[2] = 0.0;
+
+    north[0] = -1 * cos(lambda) * sin(phi);
+    north[1] = -1 * sin(lambda) * sin(phi);
+    north[2] = cos(phi);
+
+    up[0] = cos(lambda) * cos(phi);
+    up[1] = sin(lambda) * cos(phi);
+    up[2] = sin(phi);
+
+    //radius of sphere as mean radius of earth + reference height of ionosphere
+    rh = rhKm * 1000.0;
+    r = Re_mean + rh;
+    rinv = 1.0 / r;
+
+    //Substituting line m + u*d (|d| = 1) in sphere equation gives
+    // u^2 + 2 (m.d) u + (|m|^2 - r^2) = 0
+    //marker is inside sphere so constant term is negative and there is always
+    //exactly one intersection in direction of satellite.
+    cterm = (mx * mx) + (my * my) + (mz * mz) - r * r;
+};
+
+
+
+void geometry::compute(const double* X, const double* Y, const double* Z, int n,
+                       double* elevation, double* azimuth, double* ippLat, double* ippLon,
+                       double* obliquity)
+{
+    const double deg = toDegrees;
+    const double PI2 = 2.0 * M_PI;
+
+    for(int i = 0; i < n; ++i)
+    {
+        //unit line of sight vector
+        double dx = X[i] - mx;
+        double dy = Y[i] - my;
+        double dz = Z[i] - mz;
+        double inv = 1.0 / sqrt( (dx * dx) + (dy * dy) + (dz * dz) );
+        dx *= inv;
+        dy *= inv;
+        dz *= inv;
+
+        //elevation and azimuth in local ENU frame
+        double de = (dx * east[0]) + (dy * east[1]);
+        double dn = (dx * north[0]) + (dy * north[1]) + (dz * north[2]);
+        double du = (dx * up[0]) + (dy * up[1]) + (dz * up[2]);
+        double az = atan2(de, dn);
+
+        //positive root of sphere-line equation
+        double md = (mx * dx) + (my * dy) + (mz * dz);
+        double u = sqrt( (md * md) - cterm ) - md;
+
+        double px = mx + u * dx;
+        double py = my + u * dy;
+        double pz = mz + u * dz;
+        double lon = atan2(py, px) * deg;
+
+        elevation[i] = asin(du);
+        azimuth[i] = az + (az < 0.0 ? PI2 : 0.0);
+        ippLat[i] = asin(pz * rinv) * deg;
+        ippLon[i] = lon + (lon < 0.0 ? 360.0 : 0.0);
+
+        //cos of zenith angle at IPP = (IPP . d) / r = (m.d + u) / r
+        obliquity[i] = r / (md + u);
+    }
+};
+
+
+
+void geometry::compute(const triple& sat, double& elevation, double& azimuth, triple& ipp, double& obliquity)
+{
+    compute(&sat.X, &sat.Y, &sat.Z, 1, &elevation, &azimuth, &ipp.X, &ipp.Y, &obliquity);
+    ipp.Z = rh;
+};
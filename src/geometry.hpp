@@ -0,0 +1,117 @@
+/*
+    GTEC -  A high performance standardized implementation of 
+    Multi Constellation GNSS Derived TEC Calibration 
+    (Model by T/ICT4D Lab ICTP).
+    Copyright (C) 2016,2017  Muhammad Owais
+    
+    This file is part of GTEC.
+
+    GTEC is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    GTEC is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with GTEC.  If not, see <http://www.gnu.org/licenses/>.
+    
+    Disclaimer: GTEC is a research implementation which is under 
+    development and should not be considered fully functional unless 
+    otherwise stated or a release is announced. Author is providing this 
+    software on a best effort AS IS basis and do not warrant validity, 
+    functionality, and suitability for any particular purpose. All copyright 
+    notices must be kept intact. 
+
+*/
+
+
+
+
+
+#ifndef __GEOMETRY__
+#define __GEOMETRY__
+
+#include "triple.hpp"
+
+
+/**
+ * @class geometry
+ * @author Muhammad Owais
+ * @date 19/10/26
+ * @file geometry.hpp
+ * @brief Class defining station-satellite geometry engine.
+ * 
+ * This Class Defines the line of sight geometry between a fixed receiver station and 
+ * satellites, for a single layer ionosphere at reference height. Everything that depends
+ * only on the station (ENU rotation, ECEF norm, sphere-line constants) is computed once 
+ * at construction, batches of satellite positions are then processed by @ref compute 
+ * over structure of arrays, one position at a time in a scalar loop without branches.
+ */
+class geometry
+{
+  public:
+
+    //!Constructor with station position and ionosphere height.
+    /*!Constructs geometry object, precomputing station ENU basis and sphere-line constants.
+     * \param markerECEF ECEF cartesian coordinates for marker (receiver station) in meters.
+     * \param markerEllip ellipsoidal coordinates for marker (degrees, degrees, meters).
+     * \param rh Ionosphere reference height in Kilometers.
+     */
+    geometry(const triple& markerECEF, const triple& markerEllip, const double& rh);
+
+
+
+    //!Function to compute geometry for a batch of satellite positions.
+    /*!This function computes, for n satellite ECEF positions, elevation and azimuth
+     * as seen from the station, IPP (Ionospheric Pierce Point) latitude/longitude on
+     * the ionospheric sphere of radius (6371 Km + rh), and slant obliquity factor
+     * \f$ 1/\cos\chi \f$ where \f$ \chi \f$ is zenith angle at IPP.
+     * \param X Array of satellite ECEF X coordinates (meters).
+     * \param Y Array of satellite ECEF Y coordinates (meters).
+     * \param Z Array of satellite ECEF Z coordinates (meters).
+     * \param n Number of satellite positions.
+     * \param elevation Output array of elevations (radians).
+     * \param azimuth Output array of azimuths from north, clockwise in [0, 2pi) (radians).
+     * \param ippLat Output array of IPP latitudes (degrees).
+     * \param ippLon Output array of IPP longitudes in [0, 360) (degrees).
+     * \param obliquity Output array of slant obliquity factors.
+     */
+    void compute(const double* X, const double* Y, const double* Z, int n,
+                 double* elevation, double* azimuth, double* ippLat, double* ippLon,
+                 double* obliquity);
+
+
+
+    //!Function to compute geometry for a single satellite position.
+    /*!Scalar version of @ref compute.
+     * \param sat ECEF cartesian coordinates for satellite (meters).
+     * \param elevation Output elevation (radians).
+     * \param azimuth Output azimuth (radians).
+     * \param ipp Output IPP latitude, longitude (degrees) and height (meters).
+     * \param obliquity Output slant obliquity factor.
+     */
+    void compute(const triple& sat, double& elevation, double& azimuth, triple& ipp, double& obliquity);
+
+
+  private:
+
+    geometry(); //!< default hidden Constructor 
+
+    double mx; //!< Station ECEF X
+    double my; //!< Station ECEF Y
+    double mz; //!< Station ECEF Z
+
+    double east[3];  //!< Station local east unit vector
+    double north[3]; //!< Station local north unit vector
+    double up[3];    //!< Station local up unit vector
+
+    double r;     //!< Radius of ionospheric sphere
+    double rinv;  //!< Inverse radius of ionospheric sphere
+    double cterm; //!< Sphere-line constant \f$ |m|^2 - r^2 \f$
+    double rh;    //!< Ionosphere reference height in meters
+};
+
+#endif
@@ -28,150 +28,729 @@
 */
 
 #include "igrf.hpp"
+#include "constants.hpp"
 #include <fstream>
+#include <sstream>
 #include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <limits>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
 
-std::vector<std::string> igrf::linesplit(std::string str)
+static const char gridMagic[8] = { 'G', 'T', 'E', 'C', 'I', 'G', 'R', '\0' };
+static const int gridFormat = 1;
+
+
+
+bool igrf::readTextGrid(const std::string& textName, gridHeader& header, std::vector<float>& values)
+{
+    std::ifstream gridFile(textName.c_str());
+    if(!gridFile.is_open())
+        return false;
+
+    std::string line;
+    std::vector<float> lat;
+    std::vector<float> lon;
+    values.clear();
+
+    //skip initial 3 lines
+    getline(gridFile, line);
+    getline(gridFile, line);
+    getline(gridFile, line);
+    while(getline(gridFile, line))
+    {
+        //fields: latitude, longitude, height, inclination
+        const char* p = line.c_str();
+        char* end;
+        double f[4];
+        int k;
+        for(k = 0; k < 4; ++k)
+        {
+            f[k] = strtod(p, &end);
+            if(end == p)
+                break;
+            p = end;
+        }
+        if(k < 4)
+            continue;
+        lat.push_back(f[0]);
+        lon.push_back(f[1]);
+        values.push_back(f[3]);
+    }
+
+    //grid is row major by latitude, row length is number of points sharing first latitude
+    int nlon = 1;
+    while(nlon < int(lat.size()) && lat[nlon] == lat[0])
+        nlon += 1;
+    if(nlon < 2 || values.size() < 2 * std::size_t(nlon) || values.size() % nlon != 0)
+        return false;
+
+    memcpy(header.magic, gridMagic, sizeof(gridMagic));
+    header.format = gridFormat;
+    header.nlon = nlon;
+    header.nlat = values.size() / nlon;
+    header.lon0 = lon[0];
+    header.dlon = lon[1] - lon[0];
+    header.lat0 = lat[0];
+    header.dlat = (header.nlat > 1) ? lat[nlon] - lat[0] : 1.0;
+    return true;
+};
+
+
+
+bool igrf::convertGrid(const std::string& textName, const std::string& binName)
+{
+    gridHeader header;
+    std::vector<float> values;
+    if(!readTextGrid(textName, header, values))
+        return false;
+
+    //write to temporary file and rename, concurrent runs never map a partial grid
+    std::string tmpName = binName + "." + std::to_string(getpid()) + ".tmp";
+    std::ofstream out(tmpName.c_str(), std::ios::binary | std::ios::trunc);
+    if(!out.is_open())
+        return false;
+    out.write((const char*)&header, sizeof(header));
+    out.write((const char*)values.data(), values.size() * sizeof(float));
+    out.close();
+
+    if(out.fail() || rename(tmpName.c_str(), binName.c_str()) != 0)
+    {
+        remove(tmpName.c_str());
+        return false;
+    }
+    return true;
+};
+
+
+
+const float* igrf::loadGrid(const std::string& textName, gridHeader& header, std::vector<float>& values,
+                            void*& map, long long& mapSize)
 {
-    std::string field = "";
-    char tmp;
-    size_t fillcount = 1;
-    std::vector<std::string> str_vec;
-    for(int i = 0; i < str.length(); ++i)
+    map = NULL;
+    mapSize = 0;
+
+    std::string binName = textName.substr(0, textName.find_last_of('.')) + ".bin";
+    if(access(binName.c_str(), R_OK) != 0)
+        convertGrid(textName, binName);
+
+    int fd = open(binName.c_str(), O_RDONLY);
+    if(fd >= 0)
+    {
+        struct stat st;
+        if(fstat(fd, &st) == 0 && st.st_size >= (long long)sizeof(gridHeader))
         {
-            tmp = str[i];
-            if(tmp == ' ' || tmp == '\t')
+            void* p = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+            if(p != MAP_FAILED)
+            {
+                memcpy(&header, p, sizeof(gridHeader));
+                if(memcmp(header.magic, gridMagic, sizeof(gridMagic)) == 0 && header.format == gridFormat &&
+                   header.nlat > 1 && header.nlon > 1 &&
+                   st.st_size == (long long)(sizeof(gridHeader) + (long long)header.nlat * header.nlon * sizeof(float)))
                 {
-                    if(field.length() > 0)
-                        {
-                            str_vec.push_back(field);
-                            field.clear();
-                        }
+                    close(fd);
+                    map = p;
+                    mapSize = st.st_size;
+                    return (const float*)((const char*)p + sizeof(gridHeader));
                 }
-            else
+                munmap(p, st.st_size);
+            }
+        }
+        close(fd);
+    }
+
+    //no (valid) binary grid, fall back to text grid
+    if(!readTextGrid(textName, header, values))
+        return NULL;
+    return values.data();
+};
+
+
+
+//IGRF reference radius (meters)
+static const double igrfRadius = 6371200.0;
+
+
+
+// Schmidt semi-normalised associated Legendre functions P and derivatives dP/dtheta
+// for colatitude theta, indexed n(n+1)/2 + m, by recurrence over degree.
+static void legendre(int nmax, double theta, double* P, double* dP)
+{
+    double ct = std::cos(theta);
+    double st = std::sin(theta);
+
+    P[0] = 1.0;
+    dP[0] = 0.0;
+    for(int n = 1; n <= nmax; ++n)
+    {
+        int k = n * (n + 1) / 2;
+        int k1 = (n - 1) * n / 2;        //degree n-1
+        int k2 = (n - 2) * (n - 1) / 2;  //degree n-2
+        for(int m = 0; m < n; ++m)
+        {
+            double a = (2.0 * n - 1.0) / std::sqrt(double(n * n - m * m));
+            double b = (n - 1 > m) ? std::sqrt(double((n - 1) * (n - 1) - m * m) / double(n * n - m * m)) : 0.0;
+            double Pn2 = (n - 1 > m) ? P[k2 + m] : 0.0;
+            double dPn2 = (n - 1 > m) ? dP[k2 + m] : 0.0;
+            P[k + m] = a * ct * P[k1 + m] - b * Pn2;
+            dP[k + m] = a * (ct * dP[k1 + m] - st * P[k1 + m]) - b * dPn2;
+        }
+        double f = (n == 1) ? 1.0 : std::sqrt((2.0 * n - 1.0) / (2.0 * n));
+        P[k + n] = f * st * P[k1 + n - 1];
+        dP[k + n] = f * (st * dP[k1 + n - 1] + ct * P[k1 + n - 1]);
+    }
+}
+
+
+
+// Field components X (north), Y (east), Z (down) from Legendre functions of a latitude,
+// radial factors (a/r)^(n+2) and cos/sin of m*longitude.
+static void fieldSums(int nmax, const double* g, const double* h, const double* P, const double* dP,
+                      const double* ar, const double* cosm, const double* sinm, double st,
+                      double& X, double& Y, double& Z)
+{
+    X = 0.0;
+    Y = 0.0;
+    Z = 0.0;
+    for(int n = 1; n <= nmax; ++n)
+    {
+        int k = n * (n + 1) / 2;
+        double x = 0.0, y = 0.0, z = 0.0;
+        for(int m = 0; m <= n; ++m)
+        {
+            double gc = g[k + m] * cosm[m] + h[k + m] * sinm[m];
+            x += gc * dP[k + m];
+            y += m * (g[k + m] * sinm[m] - h[k + m] * cosm[m]) * P[k + m];
+            z += gc * P[k + m];
+        }
+        X += ar[n] * x;
+        Y += ar[n] * y;
+        Z -= ar[n] * (n + 1) * z;
+    }
+    Y /= st;
+}
+
+
+
+bool igrf::readCoefficients(const std::string& fname)
+{
+    std::ifstream coeffFile(fname.c_str());
+    if(!coeffFile.is_open())
+        return false;
+
+    std::string line;
+    bool hasSV = false;
+    nmax = 0;
+    epochs.clear();
+    gnm.clear();
+    hnm.clear();
+    gSV.clear();
+    hSV.clear();
+
+    while(getline(coeffFile, line))
+    {
+        std::istringstream fields(line);
+        std::string type;
+        fields >> type;
+        if(type == "g/h")
+        {
+            //model epochs, last column may be secular variation (e.g. "2020-25")
+            std::string tmp;
+            fields >> tmp >> tmp;
+            while(fields >> tmp)
+            {
+                char* end;
+                double epoch = strtod(tmp.c_str(), &end);
+                if(*end == '\0')
+                    epochs.push_back(epoch);
+                else
+                    hasSV = true;
+            }
+        }
+        else if((type == "g" || type == "h") && epochs.size() != 0)
+        {
+            int n, m;
+            fields >> n >> m;
+            if(!fields || n < 1 || m < 0 || m > n)
+                continue;
+            if(n > nmax)
+            {
+                nmax = n;
+                int size = (nmax + 1) * (nmax + 2) / 2;
+                gnm.resize(epochs.size());
+                hnm.resize(epochs.size());
+                for(size_t e = 0; e < epochs.size(); ++e)
                 {
-                    field.append(fillcount, tmp);
+                    gnm[e].resize(size, 0.0);
+                    hnm[e].resize(size, 0.0);
                 }
+                gSV.resize(size, 0.0);
+                hSV.resize(size, 0.0);
+            }
+            int k = n * (n + 1) / 2 + m;
+            std::vector< std::vector<double> >& coeff = (type == "g") ? gnm : hnm;
+            for(size_t e = 0; e < epochs.size(); ++e)
+            {
+                fields >> coeff[e][k];
+            }
+            if(hasSV)
+            {
+                fields >> ((type == "g") ? gSV[k] : hSV[k]);
+            }
         }
-    str_vec.push_back(field);
-    return str_vec;
+    }
+    return nmax > 0;
 };
 
 
 
-igrf::igrf(int igrf_Year, std::string inpDir)
+void igrf::coefficients(double t, std::vector<double>& g, std::vector<double>& h)
 {
-    //Allocate memory
-    arraySize = 181 * 360;
-    ippI = (double*) malloc( arraySize * sizeof(double) );    
-    stationI = (double*) malloc( arraySize * sizeof(double) );
-    
-    
-    std::string fnameIPP;
-    std::string fnameStation;
+    int last = epochs.size() - 1;
+    int e = 0;
+    while(e < last && epochs[e + 1] <= t)
+        e += 1;
 
-    //set filename
-    if(igrf_Year >= 2015 && igrf_Year < 2020)
+    g.resize(gnm[0].size());
+    h.resize(hnm[0].size());
+    if(t < epochs[0] && last > 0)
     {
-      fnameIPP = inpDir + "/" + "igrf_2015_IPP.txt";
-      fnameStation = inpDir + "/" + "igrf_2015_station.txt";
+        //before first model epoch, extrapolate by change over first interval
+        double w = (t - epochs[0]) / (epochs[1] - epochs[0]);
+        for(size_t k = 0; k < g.size(); ++k)
+        {
+            g[k] = gnm[0][k] + w * (gnm[1][k] - gnm[0][k]);
+            h[k] = hnm[0][k] + w * (hnm[1][k] - hnm[0][k]);
+        }
     }
-    else if(igrf_Year >= 2010)
+    else if(t < epochs[0])
     {
-      fnameIPP = inpDir + "/" + "igrf_2010_IPP.txt";
-      fnameStation = inpDir + "/" + "igrf_2010_station.txt";
+        g = gnm[0];
+        h = hnm[0];
     }
-    else if(igrf_Year >= 2005)
+    else if(e == last)
     {
-      fnameIPP = inpDir + "/" + "igrf_2005_IPP.txt";
-      fnameStation = inpDir + "/" + "igrf_2005_station.txt";
+        //after last model epoch, extrapolate by secular variation
+        double dt = t - epochs[last];
+        for(size_t k = 0; k < g.size(); ++k)
+        {
+            g[k] = gnm[last][k] + gSV[k] * dt;
+            h[k] = hnm[last][k] + hSV[k] * dt;
+        }
     }
-    else if(igrf_Year >= 2000)
+    else
     {
-      fnameIPP = inpDir + "/" + "igrf_2000_IPP.txt";
-      fnameStation = inpDir + "/" + "igrf_2000_station.txt";
+        double w = (t - epochs[e]) / (epochs[e + 1] - epochs[e]);
+        for(size_t k = 0; k < g.size(); ++k)
+        {
+            g[k] = gnm[e][k] + w * (gnm[e + 1][k] - gnm[e][k]);
+            h[k] = hnm[e][k] + w * (hnm[e + 1][k] - hnm[e][k]);
+        }
     }
-    else
+};
+
+
+
+void igrf::computeField(double r, double lat, double lon, double t, double& H, double& F, double& D, double& I)
+{
+    std::vector<double> g, h;
+    coefficients(t, g, h);
+
+    int size = (nmax + 1) * (nmax + 2) / 2;
+    std::vector<double> P(size), dP(size), ar(nmax + 1), cosm(nmax + 1), sinm(nmax + 1);
+
+    //colatitude kept off the poles, where east component is a limit
+    double theta = std::min(std::max(M_PI / 2.0 - lat, 1e-10), M_PI - 1e-10);
+    legendre(nmax, theta, P.data(), dP.data());
+
+    double ratio = igrfRadius / r;
+    ar[0] = ratio * ratio;
+    for(int n = 1; n <= nmax; ++n)
+        ar[n] = ar[n - 1] * ratio;
+    for(int m = 0; m <= nmax; ++m)
     {
-      std::cout << "Invalid year for IGRF." << std::endl;
-      exit(-1);
+        cosm[m] = std::cos(m * lon);
+        sinm[m] = std::sin(m * lon);
     }
+
+    double X, Y, Z;
+    fieldSums(nmax, g.data(), h.data(), P.data(), dP.data(), ar.data(), cosm.data(), sinm.data(),
+              std::sin(theta), X, Y, Z);
+
+    H = std::sqrt(X * X + Y * Y);
+    F = std::sqrt(H * H + Z * Z);
+    D = std::atan2(Y, X);
+    I = std::atan2(Z, H);
+};
+
+
+
+double igrf::getMODIP(const triple& pos, double t)
+{
+    double H, F, D, I;
+    computeField(pos.Z, pos.X, pos.Y, t, H, F, D, I);
+    return std::atan(I / std::sqrt(std::fabs(std::cos(pos.X))));
+};
+
+
+
+void igrf::globalGrid(gridHeader& header)
+{
+    memcpy(header.magic, gridMagic, sizeof(gridMagic));
+    header.format = gridFormat;
+    header.nlat = 181;
+    header.nlon = 360;
+    header.lat0 = -90.0;
+    header.dlat = 1.0;
+    header.lon0 = 0.0;
+    header.dlon = 1.0;
+};
+
+
+
+void igrf::computeGrid(double t, double r, const gridHeader& header, float* values, int stride)
+{
+    std::vector<double> g, h;
+    coefficients(t, g, h);
+
+    int size = (nmax + 1) * (nmax + 2) / 2;
+    std::vector<double> P(size), dP(size), ar(nmax + 1);
+
+    double ratio = igrfRadius / r;
+    ar[0] = ratio * ratio;
+    for(int n = 1; n <= nmax; ++n)
+        ar[n] = ar[n - 1] * ratio;
+
+    //cos/sin of m*longitude, shared by all rows
+    std::vector<double> cosm(header.nlon * (nmax + 1));
+    std::vector<double> sinm(header.nlon * (nmax + 1));
+    for(int j = 0; j < header.nlon; ++j)
+    {
+        double lon = (header.lon0 + j * header.dlon) * M_PI / 180.0;
+        for(int m = 0; m <= nmax; ++m)
+        {
+            cosm[j * (nmax + 1) + m] = std::cos(m * lon);
+            sinm[j * (nmax + 1) + m] = std::sin(m * lon);
+        }
+    }
+
+    double X, Y, Z;
+    for(int i = 0; i < header.nlat; ++i)
+    {
+        //Legendre functions once per latitude row
+        double lat = (header.lat0 + i * header.dlat) * M_PI / 180.0;
+        double theta = std::min(std::max(M_PI / 2.0 - lat, 1e-10), M_PI - 1e-10);
+        double st = std::sin(theta);
+        legendre(nmax, theta, P.data(), dP.data());
+
+        float* row = values + i * stride;
+        for(int j = 0; j < header.nlon; ++j)
+        {
+            fieldSums(nmax, g.data(), h.data(), P.data(), dP.data(), ar.data(),
+                      &cosm[j * (nmax + 1)], &sinm[j * (nmax + 1)], st, X, Y, Z);
+            row[j] = std::atan2(Z, std::sqrt(X * X + Y * Y)) * 180.0 / M_PI;
+        }
+    }
+};
+
+
+
+igrf::igrf(std::string fname)
+{
+    ippI = NULL;
+    stationI = NULL;
+    ippMap = NULL;
+    ippMapSize = 0;
+    stationMap = NULL;
+    stationMapSize = 0;
+    arraySize = 0;
+    epoch = 0.0;
+    ippRadius = 0.0;
+    tileHeader.nlat = 0;
+    tileMODIP = NULL;
+    tileStride = 0;
     
-    std::ifstream igrfFileIPP;
-    std::ifstream igrfFileStation;
+    if(!readCoefficients(fname))
+    {
+        std::cout << "Unable to read igrf coefficient file\n";
+        std::cout << "File Name: " << fname << std::endl;
+        exit(-1);
+    }
+};
+
 
-    igrfFileIPP.open(fnameIPP);
-    igrfFileStation.open(fnameStation);
+
+igrf::igrf(double epoch, std::string inpDir, int rh)
+{
+    this->epoch = epoch;
+    ippRadius = Re_mean + rh * 1000.0;
+    tileHeader.nlat = 0;
+    tileMODIP = NULL;
+    tileStride = 0;
+    ippMap = NULL;
+    ippMapSize = 0;
+    stationMap = NULL;
+    stationMapSize = 0;
+    nmax = 0;
     
-    std::string line;
-    int linecount = 0;
-    std::vector<std::string> fields;
-
-
-    if(igrfFileIPP.is_open())
-        {
-	    //skip initial 3 lines
-	    getline(igrfFileIPP, line);
-	    getline(igrfFileIPP, line);
-	    getline(igrfFileIPP, line);
-	    for (int i=0; i<arraySize; ++i)
-	    {
-	      getline(igrfFileIPP, line);
-	      fields = linesplit(line);
-	      ippI[i] = std::stof(fields[3]);
-	    }
-	}
-    else
+    //Grids computed from coefficients, if coefficient file is present
+    if(readCoefficients(inpDir + "/" + "igrf13coeffs.txt") || readCoefficients(inpDir + "/" + "igrf12coeffs.txt"))
+    {
+        globalGrid(ippHeader);
+        globalGrid(stationHeader);
+        ippValues.resize(ippHeader.nlat * ippHeader.nlon);
+        stationValues.resize(stationHeader.nlat * stationHeader.nlon);
+        computeGrid(epoch, ippRadius, ippHeader, ippValues.data(), ippHeader.nlon);
+        computeGrid(epoch, Re_mean, stationHeader, stationValues.data(), stationHeader.nlon);
+        ippI = ippValues.data();
+        stationI = stationValues.data();
+        arraySize = ippHeader.nlat * ippHeader.nlon;
+        return;
+    }
+    
+    //Grids exist for years 2000, 2005, 2010 and 2015, each used for five years
+    int igrf_Year = int(std::floor(epoch));
+    int gridYear = std::min(std::max(igrf_Year / 5 * 5, 2000), 2015);
+    std::string fnameIPP = inpDir + "/" + "igrf_" + std::to_string(gridYear) + "_IPP.txt";
+    std::string fnameStation = inpDir + "/" + "igrf_" + std::to_string(gridYear) + "_station.txt";
+    
+    //Grids are memory mapped from binary grid files, converted once from text grids
+    ippI = loadGrid(fnameIPP, ippHeader, ippValues, ippMap, ippMapSize);
+    if(ippI == NULL)
         {
             std::cout << "Unable to open igrf IPP file\n";
             std::cout << "File Name: " << fnameIPP << std::endl;
             exit(-1);
         }
         
-    if(igrfFileStation.is_open())
-        {
-	    //skip initial 3 lines
-	    getline(igrfFileStation, line);
-	    getline(igrfFileStation, line);
-	    getline(igrfFileStation, line);
-	    for (int i=0; i<arraySize; ++i)
-	    {
-	      getline(igrfFileStation, line);
-	      fields = linesplit(line);
-	      stationI[i] = std::stof(fields[3]);
-	    }
-	}
-    else
+    stationI = loadGrid(fnameStation, stationHeader, stationValues, stationMap, stationMapSize);
+    if(stationI == NULL)
         {
             std::cout << "Unable to open igrf Station file\n";
             std::cout << "File Name: " << fnameStation << std::endl;
             exit(-1);
         }        
-        
+
+    //Before 2000 and after 2019 inclinations are extrapolated linearly in time
+    //from the two nearest grids
+    if(epoch < 2000.0 || epoch >= 2020.0)
+    {
+        int otherYear = (gridYear == 2000) ? 2005 : 2010;
+        double w = (epoch - gridYear) / (gridYear - otherYear);
+        std::string otherIPP = inpDir + "/" + "igrf_" + std::to_string(otherYear) + "_IPP.txt";
+        std::string otherStation = inpDir + "/" + "igrf_" + std::to_string(otherYear) + "_station.txt";
+        if(!extrapolateGrid(otherIPP, w, ippI, ippHeader, ippValues, ippMap, ippMapSize) ||
+           !extrapolateGrid(otherStation, w, stationI, stationHeader, stationValues, stationMap, stationMapSize))
+        {
+            std::cout << "Unable to extrapolate igrf grids to year " << epoch << "\n";
+            std::cout << "File Names: " << otherIPP << " " << otherStation << std::endl;
+            exit(-1);
+        }
+    }
+
+    arraySize = ippHeader.nlat * ippHeader.nlon;
+};
+
+
+
+bool igrf::extrapolateGrid(const std::string& otherName, double w, const float*& grid, const gridHeader& header,
+                           std::vector<float>& values, void*& map, long long& mapSize)
+{
+    gridHeader otherHeader;
+    std::vector<float> otherValues;
+    void* otherMap;
+    long long otherMapSize;
+    const float* other = loadGrid(otherName, otherHeader, otherValues, otherMap, otherMapSize);
+    if(other == NULL)
+        return false;
+
+    bool same = otherHeader.nlat == header.nlat && otherHeader.nlon == header.nlon &&
+                otherHeader.lat0 == header.lat0 && otherHeader.dlat == header.dlat &&
+                otherHeader.lon0 == header.lon0 && otherHeader.dlon == header.dlon;
+    if(same)
+    {
+        std::vector<float> result(header.nlat * header.nlon);
+        for(size_t k = 0; k < result.size(); ++k)
+            result[k] = grid[k] + w * (grid[k] - other[k]);
+        values.swap(result);
+        grid = values.data();
+        if(map != NULL)
+            munmap(map, mapSize);
+        map = NULL;
+        mapSize = 0;
+    }
+
+    if(otherMap != NULL)
+        munmap(otherMap, otherMapSize);
+    return same;
+};
+
+
+
+inline double igrf::gridMODIP(const float* grid, const gridHeader& header, double lat, double lon)
+{
+    //points without coordinates (NaN) have no MODIP
+    if(std::isnan(lat) || std::isnan(lon))
+        return std::numeric_limits<double>::quiet_NaN();
+    
+    //fractional grid indices
+    double fi = (lat - header.lat0) / header.dlat;
+    double fj = (lon - header.lon0) / header.dlon;
+    
+    //longitudes wrap around for global grids, latitudes are clamped to grid
+    double lonSpan = header.nlon * header.dlon;
+    bool global = std::fabs(std::fabs(lonSpan) - 360.0) < 1e-3;
+    int nlon = header.nlon;
+    fj = global ? fj - nlon * std::floor(fj / nlon) : std::min(std::max(fj, 0.0), nlon - 1.0);
+    fi = std::min(std::max(fi, 0.0), header.nlat - 1.0);
+    
+    int i0 = std::min(int(fi), header.nlat - 2);
+    int j0 = std::min(int(fj), nlon - 1);
+    int j1 = global ? (j0 + 1) % nlon : std::min(j0 + 1, nlon - 1);
+    double u = fi - i0;
+    double v = fj - j0;
+    
+    const float* row0 = grid + i0 * nlon;
+    const float* row1 = row0 + nlon;
+    double I = (1.0 - u) * ((1.0 - v) * row0[j0] + v * row0[j1]) +
+               u * ((1.0 - v) * row1[j0] + v * row1[j1]);
+    
+    double phi = lat * M_PI / 180.0;
+    return std::atan(I * M_PI / 180.0 / std::sqrt(std::fabs(std::cos(phi))));
 };
 
 
 
 double igrf::getMODIP(const triple& pos)
-                      {
-                          //get inclination
-                          double lat1,lat2,lon1,lon2;
-                          lat1 = floor(pos.X);
-                          lon1 = floor(pos.Y);
-                          lat2 = ceil(pos.X);
-                          lon2 = ceil(pos.Y);
-                          
-                          std::cout << "original: " << pos.X << " " << pos.Y << std::endl;
-                          std::cout << "floor: " << lat1 << " " << lon1 << std::endl;
-                          std::cout << "ceil: " << lat2 << " " << lon2 << std::endl;
-                          std::cout << std::endl;
-                      }
+{
+    return gridMODIP(ippI, ippHeader, pos.X, pos.Y);
+};
+
+
+
+void igrf::getMODIP(const double* lat, const double* lon, double* modip, int n)
+{
+    const float* grid = ippI;
+    const gridHeader header = ippHeader;
+    //scalar lookup, tile first and IPP grid for points out of tile
+    for(int k = 0; k < n; ++k)
+    {
+        if(!tileLookup(lat[k], lon[k], modip[k]))
+            modip[k] = gridMODIP(grid, header, lat[k], lon[k]);
+    }
+};
+
+
+
+inline bool igrf::tileLookup(double lat, double lon, double& modip) const
+{
+    //NaN coordinates fail range checks
+    double fi = (lat - tileHeader.lat0) / tileHeader.dlat;
+    double dLon = lon - tileHeader.lon0;
+    dLon -= 360.0 * std::floor(dLon / 360.0);
+    double fj = dLon / tileHeader.dlon;
+    if(!(fi >= 0.0 && fi <= tileHeader.nlat - 1.0 && fj <= tileHeader.nlon - 1.0))
+        return false;
+    
+    int i0 = std::min(int(fi), tileHeader.nlat - 2);
+    int j0 = std::min(int(fj), tileHeader.nlon - 2);
+    double u = fi - i0;
+    double v = fj - j0;
+    
+    const float* row0 = tileMODIP + i0 * tileStride;
+    const float* row1 = row0 + tileStride;
+    modip = (1.0 - u) * ((1.0 - v) * row0[j0] + v * row0[j0 + 1]) +
+            u * ((1.0 - v) * row1[j0] + v * row1[j0 + 1]);
+    return true;
+};
+
+
+
+void igrf::buildTile(const triple& station)
+{
+    free(tileMODIP);
+    tileMODIP = NULL;
+    tileHeader.nlat = 0;
+    
+    //Earth central angle of IPP at zero elevation, plus one degree margin
+    double step = 0.5;
+    double radius = (ippRadius > 0.0) ? ippRadius : Re_mean + 350000.0;
+    double psi = std::acos(Re_mean / radius) * 180.0 / M_PI + 1.0;
+    double lat0 = station.X - psi;
+    double lat1 = station.X + psi;
+    if(lat0 <= -90.0 || lat1 >= 90.0)
+        return;
+    double halfLon = std::asin(std::min(std::sin(psi * M_PI / 180.0) / std::cos(station.X * M_PI / 180.0), 1.0))
+                     * 180.0 / M_PI + 1.0;
+    
+    tileHeader = ippHeader;
+    tileHeader.lat0 = std::floor(lat0 / step) * step;
+    tileHeader.dlat = step;
+    tileHeader.nlat = int(std::ceil((lat1 - tileHeader.lat0) / step)) + 1;
+    tileHeader.lon0 = std::floor((station.Y - halfLon) / step) * step;
+    tileHeader.lon0 -= 360.0 * std::floor(tileHeader.lon0 / 360.0);
+    tileHeader.dlon = step;
+    tileHeader.nlon = int(std::ceil(2.0 * halfLon / step)) + 2;
+    
+    //rows padded to 64 bytes
+    tileStride = (tileHeader.nlon + 15) / 16 * 16;
+    void* p = NULL;
+    if(posix_memalign(&p, 64, tileHeader.nlat * tileStride * sizeof(float)) != 0)
+    {
+        tileHeader.nlat = 0;
+        return;
+    }
+    tileMODIP = (float*) p;
+    
+    if(nmax > 0)
+    {
+        //inclination from coefficients, then MODIP with 1/sqrt(cos(lat)) of row
+        computeGrid(epoch, radius, tileHeader, tileMODIP, tileStride);
+        for(int i = 0; i < tileHeader.nlat; ++i)
+        {
+            double lat = (tileHeader.lat0 + i * step) * M_PI / 180.0;
+            double f = M_PI / 180.0 / std::sqrt(std::fabs(std::cos(lat)));
+            float* row = tileMODIP + i * tileStride;
+            for(int j = 0; j < tileHeader.nlon; ++j)
+            {
+                row[j] = std::atan(row[j] * f);
+            }
+        }
+    }
+    else
+    {
+        for(int i = 0; i < tileHeader.nlat; ++i)
+        {
+            float* row = tileMODIP + i * tileStride;
+            for(int j = 0; j < tileHeader.nlon; ++j)
+            {
+                row[j] = gridMODIP(ippI, ippHeader, tileHeader.lat0 + i * step, tileHeader.lon0 + j * step);
+            }
+        }
+    }
+};
+
+
+
+double igrf::getStationMODIP(const triple& pos)
+{
+    return gridMODIP(stationI, stationHeader, pos.X, pos.Y);
+};
 
 
 
 //Destructor
 igrf::~igrf()
 {
-    free(ippI);
-    free(stationI);
+    free(tileMODIP);
+    if(ippMap != NULL)
+        munmap(ippMap, ippMapSize);
+    if(stationMap != NULL)
+        munmap(stationMap, stationMapSize);
 };
\ No newline at end of file
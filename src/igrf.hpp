@@ -50,6 +50,11 @@
  * An instance of this class could be created using a generation of IGRF coefficients, 
  * currently <a href="http://earth-planets-space.springeropen.com/articles/10.1186/s40623-015-0228-9">IGRF-12</a>
  * which would be valid for years 1900 to 2020. 
+ * 
+ * Field is evaluated natively from Gauss coefficients (NOAA coefficient file format, e.g.
+ * igrf13coeffs.txt), interpolated linearly to epoch between model epochs, extrapolated
+ * using secular variation after last epoch and by change over first interval before first epoch. Schmidt semi-normalised Legendre functions are
+ * computed by recurrence once per latitude and shared by all longitudes of a grid row.
  */
 
 class igrf
@@ -57,43 +62,252 @@ class igrf
     
 public:
 
-    //!Constructor with Input file
-    /*!Constructs igrf object by reading input computed IGRF Model file, given Model year as @ref igrf_Year.
-        * \param igrf_Year IGRF Model year. 
+    //!Constructor with Input directory
+    /*!Constructs igrf object with inclination grids for MODIP. If coefficient file 
+     * (igrf13coeffs.txt or igrf12coeffs.txt) is present in input directory, grids are computed
+     * natively for epoch at ionosphere height and at surface, otherwise computed grid files
+     * are loaded given Model year. Grid files cover years 2000 to 2019, for other years 
+     * inclinations are extrapolated linearly from the two nearest grids.
+        * \param epoch Epoch in decimal years. 
+        * \param inpDir Input directory.
+        * \param rh Ionosphere reference height in Kilometers.
+        */
+    igrf(double epoch, std::string inpDir, int rh);
+    
+    
+    //!Constructor with coefficient file
+    /*!Constructs igrf object by reading Gauss coefficients from coefficient file, 
+     * for point evaluation by @ref computeField, no grids are computed.
+        * \param fname Coefficient file name. 
         */
-    igrf(int igrf_Year, std::string inpDir);
+    igrf(std::string fname);
+    
+    
+    //!Function to compute field components.
+    /*!This function computes geomagnetic field at a geocentric point and epoch.
+        * \param r Geocentric radius (meters).
+        * \param lat Geocentric latitude (radians).
+        * \param lon Longitude (radians).
+        * \param t Epoch in decimal years.
+        * \param H Output horizontal intensity (nT).
+        * \param F Output total intensity (nT).
+        * \param D Output declination (radians).
+        * \param I Output inclination (radians).
+        */
+    void computeField(double r, double lat, double lon, double t, double& H, double& F, double& D, double& I);
+    
+    
+    //!Function to compute MODIP at a point and epoch.
+    /*!This function computes MODIP from inclination evaluated by @ref computeField.
+        * \param pos geocentric coordinates of the point as @ref triple object (latitude, 
+        * longitude in radians, radius in meters).
+        * \param t Epoch in decimal years.
+        * \return Returns computed MODIP (radians).
+        */    
+    double getMODIP(const triple& pos, double t);
     
     
     //!Function to compute MODIP.
     /*!This function compute MODIP (Modified Dip) given ellipsoidal coordinates of 
-     * the point.
-        * \param pos ellipsoidal coordinates of the point as @ref triple object.
-        * \return Returns computed MODIP.
+     * the point at ionosphere height, \f$ \mu = atan(I / \sqrt{cos \phi}) \f$ with 
+     * inclination I bilinearly interpolated from IPP grid.
+        * \param pos ellipsoidal coordinates of the point as @ref triple object (latitude, longitude in degrees).
+        * \return Returns computed MODIP (radians).
         */    
     double getMODIP(const triple& pos);
+    
+    
+    //!Function to compute MODIP for a batch of points.
+    /*!Batch version of @ref getMODIP over structure of arrays, without I/O. Points are
+     * looked up one by one, in station tile (see @ref buildTile) if they fall in it,
+     * otherwise in IPP grid. NaN coordinates give NaN MODIP.
+        * \param lat Latitudes (degrees).
+        * \param lon Longitudes (degrees).
+        * \param modip Output MODIP (radians).
+        * \param n Number of points.
+        */    
+    void getMODIP(const double* lat, const double* lon, double* modip, int n);
+    
+    
+    //!Function to compute MODIP at station.
+    /*!This function compute MODIP as @ref getMODIP, with inclination interpolated 
+     * from station (surface) grid.
+        * \param pos ellipsoidal coordinates of the station as @ref triple object (latitude, longitude in degrees).
+        * \return Returns computed MODIP (radians).
+        */    
+    double getStationMODIP(const triple& pos);
+    
+    
+    //!Function to build station-local MODIP tile.
+    /*!This function builds a MODIP tile (0.5 degree step) covering IPP footprint of a station, 
+     * i.e. IPPs down to zero elevation at ionosphere height. Tile stores MODIP (radians) as
+     * float with cache line aligned rows, so @ref getMODIP only interpolates MODIP values.
+     * Tile is computed from coefficients when available, otherwise from IPP grid. Points out 
+     * of tile are interpolated from IPP grid. No tile is built for stations whose footprint
+     * covers a pole.
+        * \param station ellipsoidal coordinates of the station as @ref triple object (latitude, longitude in degrees).
+        */
+    void buildTile(const triple& station);
                     
 
     ~igrf();
 
 
+    //! Header of binary inclination grid file.
+    struct gridHeader
+    {
+        char magic[8];  //!< File identifier "GTECIGR"
+        int format;     //!< Grid format version
+        int nlat;       //!< Number of grid rows (latitudes)
+        int nlon;       //!< Number of grid columns (longitudes)
+        float lat0;     //!< Latitude of first row (degrees)
+        float dlat;     //!< Latitude step between rows (degrees)
+        float lon0;     //!< Longitude of first column (degrees)
+        float dlon;     //!< Longitude step between columns (degrees)
+    };
+    
+    
+    //!Function to convert text inclination grid to binary grid.
+    /*!This function reads a text grid (3 header lines, then one line per grid point
+     * with latitude, longitude, height and inclination) and writes binary grid 
+     * file, a @ref gridHeader followed by inclinations as float array, row major by latitude.
+     * \param textName Text grid file name.
+     * \param binName Binary grid file name.
+     * \return Returns false if text grid can not be read or binary grid can not be written.
+     */
+    static bool convertGrid(const std::string& textName, const std::string& binName);
+
+
     
 private:
   
   
     //!Inclation on lat/long grid for IPP at height 350 KMs.
-    double* ippI;
+    const float* ippI;
     
     //!Inclation on lat/long grid for station at height 0 KMs surface.
-    double* stationI;    
+    const float* stationI;    
+    
+    gridHeader ippHeader;      //!< Geometry of @ref ippI grid
+    gridHeader stationHeader;  //!< Geometry of @ref stationI grid
+
+    std::vector<float> ippValues;      //!< Storage of @ref ippI when read from text grid or extrapolated
+    std::vector<float> stationValues;  //!< Storage of @ref stationI when read from text grid or extrapolated
+    
+    void* ippMap;             //!< Mapping of binary IPP grid file
+    long long ippMapSize;     //!< Size of binary IPP grid mapping
+    void* stationMap;         //!< Mapping of binary station grid file
+    long long stationMapSize; //!< Size of binary station grid mapping
     
 
     //!Total size of array to store all values present in igrf-12 coefficients file
     int arraySize;
     
+    
+    int nmax;                   //!< Maximum degree of coefficients
+    std::vector<double> epochs; //!< Model epochs (decimal years)
+    
+    //! Gauss coefficients g for each model epoch, indexed n(n+1)/2 + m.
+    std::vector< std::vector<double> > gnm;
+    //! Gauss coefficients h for each model epoch, indexed n(n+1)/2 + m.
+    std::vector< std::vector<double> > hnm;
+    std::vector<double> gSV; //!< Secular variation of g after last epoch (nT/year)
+    std::vector<double> hSV; //!< Secular variation of h after last epoch (nT/year)
+    
+    double epoch;     //!< Epoch of grids (decimal years)
+    double ippRadius; //!< Geocentric radius of IPP grid (meters)
+    
+    gridHeader tileHeader; //!< Geometry of station-local tile, nlat is 0 without tile
+    float* tileMODIP;      //!< Station-local MODIP tile (radians), 64 byte aligned rows
+    int tileStride;        //!< Number of floats between tile rows
+    
 
     igrf();
     
-    std::vector<std::string> linesplit(std::string str);
+    
+    //!Function to read Gauss coefficients.
+    /*!\param fname Coefficient file name.
+     * \return Returns false if file can not be read.
+     */
+    bool readCoefficients(const std::string& fname);
+    
+    //!Function to get Gauss coefficients at epoch.
+    /*!Coefficients are interpolated linearly between model epochs, extrapolated by secular 
+     * variation after last epoch and by change over first interval before first epoch.
+     * \param t Epoch in decimal years.
+     * \param g Output coefficients g, indexed n(n+1)/2 + m.
+     * \param h Output coefficients h, indexed n(n+1)/2 + m.
+     */
+    void coefficients(double t, std::vector<double>& g, std::vector<double>& h);
+    
+    //!Function to compute inclination grid.
+    /*!This function computes inclination (degrees) on a grid at a radius.
+     * \param t Epoch in decimal years.
+     * \param r Geocentric radius (meters).
+     * \param header Grid geometry.
+     * \param values Output inclinations.
+     * \param stride Number of values between grid rows.
+     */
+    void computeGrid(double t, double r, const gridHeader& header, float* values, int stride);
+    
+    //!Function to set geometry of 1 degree global grid.
+    static void globalGrid(gridHeader& header);
+    
+    
+    //!Function to interpolate MODIP from an inclination grid.
+    /*!\param grid Inclination grid (degrees).
+     * \param header Grid geometry.
+     * \param lat Latitude (degrees).
+     * \param lon Longitude (degrees).
+     * \return Returns MODIP (radians) at lat/lon.
+     */
+    static double gridMODIP(const float* grid, const gridHeader& header, double lat, double lon);
+    
+    //!Function to interpolate MODIP from station-local tile.
+    /*!\param lat Latitude (degrees).
+     * \param lon Longitude (degrees).
+     * \param modip Output MODIP (radians).
+     * \return Returns false if point is out of tile.
+     */
+    bool tileLookup(double lat, double lon, double& modip) const;
+    
+    
+    //!Function to load an inclination grid.
+    /*!This function memory maps binary grid (text grid name with ".bin" extension), 
+     * if binary grid does not exist it is converted from text grid first, if conversion 
+     * is not possible (e.g. read-only directory) text grid is read into values.
+     * \param textName Text grid file name.
+     * \param header Output grid geometry.
+     * \param values Storage for grid read from text.
+     * \param map Output mapping, NULL if grid read from text.
+     * \param mapSize Output mapping size.
+     * \return Returns pointer to first grid value, NULL if grid can not be loaded.
+     */
+    static const float* loadGrid(const std::string& textName, gridHeader& header, std::vector<float>& values,
+                                 void*& map, long long& mapSize);
+    
+    //!Function to read a text inclination grid.
+    /*!\param textName Text grid file name.
+     * \param header Output grid geometry, derived from grid point coordinates.
+     * \param values Output inclinations.
+     * \return Returns false if file can not be read.
+     */
+    static bool readTextGrid(const std::string& textName, gridHeader& header, std::vector<float>& values);
+    
+    //!Function to extrapolate an inclination grid in time.
+    /*!Grid becomes grid + w * (grid - other), with other loaded by @ref loadGrid. Result is
+     * kept in values and mapping of grid, if any, is released.
+     * \param otherName Text grid file name of other epoch.
+     * \param w Ratio of time from grid epoch to grid epoch minus other epoch.
+     * \param grid Grid, updated to point to values.
+     * \param header Grid geometry, other grid must have same geometry.
+     * \param values Storage for extrapolated grid.
+     * \param map Mapping of grid, NULL on return.
+     * \param mapSize Mapping size, 0 on return.
+     * \return Returns false if other grid can not be loaded or has different geometry.
+     */
+    static bool extrapolateGrid(const std::string& otherName, double w, const float*& grid, const gridHeader& header,
+                                std::vector<float>& values, void*& map, long long& mapSize);
             
 };
 
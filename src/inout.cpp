@@ -31,6 +31,7 @@
 #include <iostream>
 #include <fstream>
 #include "inout.hpp"
+#include "constants.hpp"
 #include <string>
 #include <sstream>
 #include <algorithm>
@@ -46,6 +47,34 @@ inout::inout()
     bool systemGalileo = false;
     bool systemBeidou = false;
     bool systemQZSS = false;
+    
+    //Default elevation mask (keeps all data)
+    minElevation = 0.0;
+    maxElevation = 90.0;
+    
+    //Default real-time mode waits for observation file rotation
+    streamIdle = 0;
+    
+    //Default no decimation (keeps all epochs)
+    decimation = 0;
+    decimationOffset = 0;
+    
+    //Default 12 hours of adjacent days are read, arcs of at least 2 hours are solved
+    marginHours = 12;
+    minSolutionArc = 2;
+    
+    //Default phase arcs are not levelled to code
+    codeLevelling = false;
+    
+    //Default out-liers are levelled to mean of 3 previous and 3 next epochs
+    sgHalfWindow = 3;
+    sgOrder = 1;
+    
+    //Default code-derived TEC is not smoothed
+    hatchWindow = 0;
+    
+    //Default ROTI over 5 minutes
+    rotiWindow = 300;
 };
 
 
@@ -210,6 +239,31 @@ void inout::process_Inputs(int ac, char* args[])
                     //Set marker (station) name
                     marker = line.substr(line.find( '=' )+1);
                 }
+                else if (parameter == "STREAMFILE")
+                {
+                    //Set observation file for real-time mode
+                    streamFile = line.substr(line.find( '=' )+1);
+                }
+                else if (parameter == "STREAMIDLE")
+                {
+                    //Set idle timeout of real-time mode
+                    value = line.substr(line.find( '=' )+1);
+                    try
+                    {
+                        streamIdle = stoi(value);
+                    }
+                    catch (std::exception& e)
+                    {
+                        std::cout << "Invalid parameter value in config file at line: " << lineNumber << "\n";
+                        exit(1);
+                    }
+                    if(streamIdle < 0)
+                    {
+                        std::cout << "Invalid parameter value in config file at line: " << lineNumber << "\n";
+                        std::cout << "STREAMIDLE should not be negative.\n";
+                        exit(1);
+                    }
+                }
                 else if (parameter == "NUMCOEFFS")
                 {
                     value = line.substr(line.find( '=' )+1);
@@ -252,6 +306,177 @@ void inout::process_Inputs(int ac, char* args[])
                         exit(1);
                     }
                 }
+                else if (parameter == "MINELEV" || parameter == "MAXELEV")
+                {
+                    //Set elevation mask limits
+                    value = line.substr(line.find( '=' )+1);
+                    float elevation;
+                    try
+                    {
+                        elevation = stof(value);
+                    }
+                    catch (std::exception& e)
+                    {
+                        std::cout << "Invalid parameter value in config file at line: " << lineNumber << "\n";
+                        exit(1);
+                    }
+                    //Elevation range (0-90)
+                    if(elevation < 0.0 || elevation > 90.0)
+                    {
+                        std::cout << "Invalid parameter value in config file at line: " << lineNumber << "\n";
+                        std::cout << "Valid range for " << parameter << " is (0-90).\n";
+                        exit(1);
+                    }
+                    if(parameter == "MINELEV")
+                        minElevation = elevation;
+                    else
+                        maxElevation = elevation;
+                }
+                else if (parameter == "DECIMATION" || parameter == "DECIMOFFSET")
+                {
+                    //Set parse-time decimation
+                    value = line.substr(line.find( '=' )+1);
+                    int seconds;
+                    try
+                    {
+                        seconds = stoi(value);
+                    }
+                    catch (std::exception& e)
+                    {
+                        std::cout << "Invalid parameter value in config file at line: " << lineNumber << "\n";
+                        exit(1);
+                    }
+                    //Decimation range (0-3600)
+                    if(seconds < 0 || seconds > 3600)
+                    {
+                        std::cout << "Invalid parameter value in config file at line: " << lineNumber << "\n";
+                        std::cout << "Valid range for " << parameter << " is (0-3600).\n";
+                        exit(1);
+                    }
+                    if(parameter == "DECIMATION")
+                        decimation = seconds;
+                    else
+                        decimationOffset = seconds;
+                }
+                else if (parameter == "MARGIN" || parameter == "MINSOLARC")
+                {
+                    //Set rejection margin and minimum solution arc
+                    value = line.substr(line.find( '=' )+1);
+                    int hours;
+                    try
+                    {
+                        hours = stoi(value);
+                    }
+                    catch (std::exception& e)
+                    {
+                        std::cout << "Invalid parameter value in config file at line: " << lineNumber << "\n";
+                        exit(1);
+                    }
+                    //Hours range (0-24)
+                    if(hours < 0 || hours > 24)
+                    {
+                        std::cout << "Invalid parameter value in config file at line: " << lineNumber << "\n";
+                        std::cout << "Valid range for " << parameter << " is (0-24).\n";
+                        exit(1);
+                    }
+                    if(parameter == "MARGIN")
+                        marginHours = hours;
+                    else
+                        minSolutionArc = hours;
+                }
+                else if (parameter == "CODELEVEL")
+                {
+                    //Set carrier-to-code levelling
+                    value = line.substr(line.find( '=' )+1);
+                    int flag;
+                    try
+                    {
+                        flag = stoi(value);
+                    }
+                    catch (std::exception& e)
+                    {
+                        std::cout << "Invalid parameter value in config file at line: " << lineNumber << "\n";
+                        exit(1);
+                    }
+                    if(flag != 0 && flag != 1)
+                    {
+                        std::cout << "Invalid parameter value in config file at line: " << lineNumber << "\n";
+                        std::cout << "Valid values for " << parameter << " are 0 and 1.\n";
+                        exit(1);
+                    }
+                    codeLevelling = (flag == 1);
+                }
+                else if (parameter == "QCFILE")
+                {
+                    //Set arc quality metrics file
+                    qualityFile = line.substr(line.find( '=' )+1);
+                }
+                else if (parameter == "ROTIFILE")
+                {
+                    //Set rate of TEC and ROTI file
+                    rotiFile = line.substr(line.find( '=' )+1);
+                }
+                else if (parameter == "ROTIWINDOW")
+                {
+                    //Set ROTI window
+                    value = line.substr(line.find( '=' )+1);
+                    try
+                    {
+                        rotiWindow = stoi(value);
+                    }
+                    catch (std::exception& e)
+                    {
+                        std::cout << "Invalid parameter value in config file at line: " << lineNumber << "\n";
+                        exit(1);
+                    }
+                    //Window range (60-3600)
+                    if(rotiWindow < 60 || rotiWindow > 3600)
+                    {
+                        std::cout << "Invalid parameter value in config file at line: " << lineNumber << "\n";
+                        std::cout << "Valid range for ROTIWINDOW is (60-3600) seconds.\n";
+                        exit(1);
+                    }
+                }
+                else if (parameter == "HATCHWINDOW")
+                {
+                    //Set Hatch filter window
+                    value = line.substr(line.find( '=' )+1);
+                    try
+                    {
+                        hatchWindow = stoi(value);
+                    }
+                    catch (std::exception& e)
+                    {
+                        std::cout << "Invalid parameter value in config file at line: " << lineNumber << "\n";
+                        exit(1);
+                    }
+                    //Window range (0-3600)
+                    if(hatchWindow < 0 || hatchWindow > 3600)
+                    {
+                        std::cout << "Invalid parameter value in config file at line: " << lineNumber << "\n";
+                        std::cout << "Valid range for HATCHWINDOW is (0-3600) seconds.\n";
+                        exit(1);
+                    }
+                }
+                else if (parameter == "SGWINDOW" || parameter == "SGORDER")
+                {
+                    //Set out-lier levelling filter
+                    value = line.substr(line.find( '=' )+1);
+                    int number;
+                    try
+                    {
+                        number = stoi(value);
+                    }
+                    catch (std::exception& e)
+                    {
+                        std::cout << "Invalid parameter value in config file at line: " << lineNumber << "\n";
+                        exit(1);
+                    }
+                    if(parameter == "SGWINDOW")
+                        sgHalfWindow = number;
+                    else
+                        sgOrder = number;
+                }
                 else
                 {
                     //Invalid parameter
@@ -269,6 +494,30 @@ void inout::process_Inputs(int ac, char* args[])
     }
     inpfile.close();
     
+    if(minElevation >= maxElevation)
+    {
+        std::cout << "Invalid elevation mask in config file, MINELEV should be less than MAXELEV.\n";
+        exit(1);
+    }
+    
+    if(decimationOffset != 0 && decimationOffset >= decimation)
+    {
+        std::cout << "Invalid decimation in config file, DECIMOFFSET should be less than DECIMATION.\n";
+        exit(1);
+    }
+    
+    if(deg < 2 || deg > MAX_INTERPOLATION_DEGREE || deg % 2 != 0)
+    {
+        std::cout << "Invalid interpolation degree in config file, DEGREE should be even and between 2 and " << MAX_INTERPOLATION_DEGREE << ".\n";
+        exit(1);
+    }
+    
+    if(sgHalfWindow < 1 || sgHalfWindow > MAX_SG_HALF_WINDOW || sgOrder < 0 || sgOrder > MAX_SG_ORDER || sgOrder >= 2 * sgHalfWindow)
+    {
+        std::cout << "Invalid out-lier filter in config file, SGWINDOW should be between 1 and " << MAX_SG_HALF_WINDOW 
+                  << ", SGORDER between 0 and " << MAX_SG_ORDER << " and less than 2 * SGWINDOW.\n";
+        exit(1);
+    }
     
     checkInputFiles();
     
@@ -288,6 +537,8 @@ void inout::checkInputFiles()
     
     int dayStart;
     int dayEnd;
+    int obsDayStart;
+    int obsDayEnd;
     int fileDay;
     
     
@@ -302,6 +553,11 @@ void inout::checkInputFiles()
     
     dayEnd = firstDayOfYear + numDays;
     
+    //observation files of adjacent days are needed only for a margin
+    int adjacentDays = (marginHours > 0) ? 2 : 0;
+    obsDayStart = (marginHours > 0) ? dayStart : firstDayOfYear;
+    obsDayEnd = (marginHours > 0) ? dayEnd : dayEnd - 1;
+    
     
     if(exists(p))
     {
@@ -323,7 +579,7 @@ void inout::checkInputFiles()
                     if (tmp.size() == 12)
                     {
                         fileDay = stoi(tmp.substr(4, 3));
-                        if (fileDay >= dayStart && fileDay <= dayEnd)
+                        if (fileDay >= obsDayStart && fileDay <= obsDayEnd)
                         {
                             obsfiles.push_back(pathString);
                         }
@@ -334,7 +590,7 @@ void inout::checkInputFiles()
                         fileDay = stoi(tmp.substr(16, 3));        //std::cout << "<<<<< " << i <<  " >>>>>>>>\n";
 
                         std::cout << fileDay << "\n";
-                        if (fileDay >= dayStart && fileDay <= dayEnd)
+                        if (fileDay >= obsDayStart && fileDay <= obsDayEnd)
                         {
                             obsfiles.push_back(pathString);
                         }
@@ -374,7 +630,18 @@ void inout::checkInputFiles()
     
     //Check if enough files are found!
     
-    if ( (obsfiles.size() != (numDays + 2)) || (navfiles.size() != (numDays + 2)) )
+    //In real-time mode observations come from stream file, navigation files available so far are used
+    if ( !streamFile.empty() )
+    {
+        if (navfiles.size() == 0)
+        {
+            std::cout << "No nav files in input directory.\n";
+            exit(1);
+        }
+        return;
+    }
+    
+    if ( (obsfiles.size() != (numDays + adjacentDays)) || (navfiles.size() != (numDays + 2)) )
     {
         std::cout << "Not enough obs/nav files in input directory.\n";
         exit(1);
@@ -397,7 +664,18 @@ void inout::dump(std::ostream& s)
     s << "Minimum Arc Length: " << minArcLen << "\n";
     s << "Interpolation Interval: " << intrpolIntrvl << "\n";
     s << "Interpolation Degree: " << deg << "\n";
+    s << "Elevation Mask: " << minElevation << " - " << maxElevation << "\n";
+    s << "Decimation: " << decimation << " (offset " << decimationOffset << ")\n";
+    s << "Margin: " << marginHours << " hours, Minimum Solution Arc: " << minSolutionArc << " hours\n";
+    s << "Code Levelling: " << (codeLevelling ? "yes" : "no") << ", Hatch Window: " << hatchWindow << " seconds\n";
+    s << "Out-lier Filter: half window " << sgHalfWindow << ", order " << sgOrder << "\n";
+    if(!qualityFile.empty())
+        s << "Arc Quality File: " << qualityFile << "\n";
+    if(!rotiFile.empty())
+        s << "ROTI File: " << rotiFile << ", window " << rotiWindow << " seconds\n";
     s << "Marker Name: " << marker << "\n";
+    if(!streamFile.empty())
+        s << "Stream File: " << streamFile << ", idle timeout " << streamIdle << " seconds\n";
     s << "Observation Files:\n";
     for (auto file: obsfiles)
     {
@@ -52,6 +52,8 @@ class inout
     std::string inputDirectory;
     std::string satSys;
     std::string marker;
+    std::string streamFile;   //Observation file followed while being written (real-time mode), empty for batch mode
+    int streamIdle;           //Seconds without new data ending real-time mode, 0 waits for file rename or removal
     int samplingTime;
     int firstDayOfYear;
     int year;
@@ -62,6 +64,19 @@ class inout
     int deg;
     int numCoeffs;
     int rh;
+    float minElevation;
+    float maxElevation;
+    int decimation;         //Observation interval (Seconds) kept while parsing, 0 keeps all epochs
+    int decimationOffset;   //Seconds after multiples of decimation at which epochs are kept
+    int marginHours;        //Hours around processed days read and preprocessed, kept out of solution
+    int minSolutionArc;     //Minimum duration (Hours) of an arc entering the solution
+    bool codeLevelling;     //Whether phase arcs are levelled to code-derived TEC
+    int sgHalfWindow;       //Epochs on each side of an out-lier used to estimate it
+    int sgOrder;            //Order of polynomial fitted to epochs around an out-lier
+    int hatchWindow;        //Hatch filter window (seconds) of code-derived TEC, 0 if disabled
+    std::string qualityFile; //CSV file of arc quality metrics, empty if not written
+    std::string rotiFile;   //Binary file of rate of TEC and ROTI, empty if not written
+    int rotiWindow;         //ROTI window (seconds)
 
      //Observation file names from imput directory
 	std::vector<std::string> obsfiles;	 
@@ -32,6 +32,9 @@
 
 
 #include "internalTime.hpp"
+#include "fieldParser.hpp"
+#include <cstdlib>
+#include <cmath>
 
 internalTime::internalTime()
 {
@@ -41,6 +44,7 @@ internalTime::internalTime()
 	hour = 0;
 	minute = 0;
 	second = 0;
+	nanosecond = 0;
 	UNIX = 0;
 };
 
@@ -53,111 +57,204 @@ internalTime::internalTime(int Y, int M, int D, int h, int m, int s)
 	hour = h;
 	minute = m;
 	second = s;
+	nanosecond = 0;
+	UNIX = 0;
 };
 
 
 void internalTime::parse(std::string str)
 {
-	str = str.substr(1);
-
-	size_t pos;
-	year = std::stoi(str,&pos);
-	str = str.substr(pos);
-	month = std::stoi(str,&pos);
-	str = str.substr(pos);
-	day = std::stoi(str,&pos);
-	str = str.substr(pos);
-	hour = std::stoi(str,&pos);
-	str = str.substr(pos);
-	minute = std::stoi(str,&pos);
-	str = str.substr(pos);
-	second = std::stoi(str,&pos);
+	//whitespace separated fields after first character
+	const char* p = str.c_str() + 1;
+	char* end;
+	year = strtol(p, &end, 10);
+	month = strtol(end, &end, 10);
+	day = strtol(end, &end, 10);
+	hour = strtol(end, &end, 10);
+	minute = strtol(end, &end, 10);
+	setSeconds(strtod(end, &end));
 };
 
 
 //This routine also returns remaining string after conversion
 void internalTime::parse(std::string str, std::string &sys)
 {
-	str = str.substr(1);
-	float s;
+	const char* p = str.c_str() + 1;
+	char* end;
+	year = strtol(p, &end, 10);
+	month = strtol(end, &end, 10);
+	day = strtol(end, &end, 10);
+	hour = strtol(end, &end, 10);
+	minute = strtol(end, &end, 10);
+	setSeconds(strtod(end, &end));
+	sys = std::string(end);
+};
 
-	size_t pos;
-	year = std::stoi(str,&pos);
-	str = str.substr(pos);
-	month = std::stoi(str,&pos);
-	str = str.substr(pos);
-	day = std::stoi(str,&pos);
-	str = str.substr(pos);
-	hour = std::stoi(str,&pos);
-	str = str.substr(pos);
-	minute = std::stoi(str,&pos);
-	str = str.substr(pos);
-	s = std::stof(str,&pos);
-	second = int(s);
-	sys = str.substr(pos);
+
+bool internalTime::parseEpoch(const char* line, int len)
+{
+	// EPOCH RECORD  -->  A1,1X,I4,4(1X,I2.2),F11.7
+	// F11.7 is read as integer part (columns 18-20) and 7 decimals
+	// (columns 22-28), so that fraction is kept exactly in nanoseconds
+	int frac;
+	bool ok = fieldParser::toInt(line, len, 2, 4, year);
+	ok = ok && fieldParser::toInt(line, len, 7, 2, month);
+	ok = ok && fieldParser::toInt(line, len, 10, 2, day);
+	ok = ok && fieldParser::toInt(line, len, 13, 2, hour);
+	ok = ok && fieldParser::toInt(line, len, 16, 2, minute);
+	ok = ok && fieldParser::toInt(line, len, 18, 3, second);
+	ok = ok && len >= 29 && line[21] == '.';
+	ok = ok && fieldParser::toInt(line, len, 22, 7, frac);
+	nanosecond = frac * 100;
+	return ok && month >= 1 && month <= 12 && frac >= 0;
+};
+
+
+long long internalTime::daysFromCivil(int Y, int M, int D)
+{
+	//Years start in March so that leap day is the last day of year
+	Y -= (M <= 2);
+	long long era = (Y >= 0 ? Y : Y - 399) / 400;
+	long long yoe = Y - era * 400;                                  //[0, 399]
+	long long doy = (153 * (M > 2 ? M - 3 : M + 9) + 2) / 5 + D - 1; //[0, 365]
+	long long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;          //[0, 146096]
+	return era * 146097 + doe - 719468;
+};
+
+
+void internalTime::setSeconds(double s)
+{
+	//round to nanoseconds first, so that 29.9999999999 becomes 30 s
+	long long ns = llround(s * NANO);
+	second = ns / NANO;
+	nanosecond = ns - second * NANO;
+};
+
+
+long long internalTime::UNIXNano() const
+{
+	return UNIX * NANO + nanosecond;
 };
 
 
 void internalTime::toUNIXTime()
 {
 	//Epoch for Unix internalTime is January 01, 1970, midnight UTC/GMT
-	//first count year difference
-	int monthDays[12] = {31,59,90,120,151,181,212,243,273,304,334,365};
-	int years_elapsed = year - 1970;
-	int UNIXTime = years_elapsed * 365 * 24 * 60 * 60;
-	UNIXTime += monthDays[month-2] * 24 * 60 * 60;
-	UNIXTime += (day - 1) * 24 * 60 * 60;
-	UNIXTime += hour * 60 * 60;
-	UNIXTime += minute * 60;
-	UNIXTime += second;
-	//Now this internalTime should be added with leap days since 1970 due to leap years
-	int leapCount = 0;
-	bool isLeap = false;
-	for(int y = 1970; y<=year; ++y)
-	{
-		if ( (y%4 == 0) && (!(y%100 == 0)) )
-			isLeap = true;
-
-		if ( (y%4 == 0) && (y%100 == 0) && (y%400 == 0) )
-			isLeap = true;
-		if(isLeap)
-			leapCount += 1;
-	}
-	UNIXTime += leapCount * 24 * 60 * 60;
 	//This is standard UNIX internalTime without leap seconds
-	
-	UNIX = UNIXTime;
+	UNIX = daysFromCivil(year, month, day) * 86400LL + hour * 3600 + minute * 60 + second;
 };
 
 
 void internalTime::toUNIXTime(int leapSeconds)
 {
-	//Epoch for Unix internalTime is January 01, 1970, midnight UTC/GMT
-	//first count year difference
-	int monthDays[12] = {31,59,90,120,151,181,212,243,273,304,334,365};
-	int years_elapsed = year - 1970;
-	int UNIXTime = years_elapsed * 365 * 24 * 60 * 60;
-	UNIXTime += monthDays[month-2] * 24 * 60 * 60;
-	UNIXTime += (day - 1) * 24 * 60 * 60;
-	UNIXTime += hour * 60 * 60;
-	UNIXTime += minute * 60;
-	UNIXTime += second;
-	//Now this internalTime should be added with leap days since 1970 due to leap years
-	int leapCount = 0;
-	bool isLeap = false;
-	for(int y = 1970; y<=year; ++y)
+	//Adding leap seconds
+	toUNIXTime();
+	UNIX += leapSeconds;
+};
+
+
+
+//UTC instants (UNIX) of leap seconds, TAI - UTC is 10 s before first one and
+//increases by one second at each of them.
+static const long long leapInstants[] = {
+	78796800LL,   //01/07/1972
+	94694400LL,   //01/01/1973
+	126230400LL,  //01/01/1974
+	157766400LL,  //01/01/1975
+	189302400LL,  //01/01/1976
+	220924800LL,  //01/01/1977
+	252460800LL,  //01/01/1978
+	283996800LL,  //01/01/1979
+	315532800LL,  //01/01/1980
+	362793600LL,  //01/07/1981
+	394329600LL,  //01/07/1982
+	425865600LL,  //01/07/1983
+	489024000LL,  //01/07/1985
+	567993600LL,  //01/01/1988
+	631152000LL,  //01/01/1990
+	662688000LL,  //01/01/1991
+	709948800LL,  //01/07/1992
+	741484800LL,  //01/07/1993
+	773020800LL,  //01/07/1994
+	820454400LL,  //01/01/1996
+	867715200LL,  //01/07/1997
+	915148800LL,  //01/01/1999
+	1136073600LL, //01/01/2006
+	1230768000LL, //01/01/2009
+	1341100800LL, //01/07/2012
+	1435708800LL, //01/07/2015
+	1483228800LL  //01/01/2017
+};
+static const int numLeaps = sizeof(leapInstants) / sizeof(leapInstants[0]);
+
+//TAI - GPS
+static const int taiGps = 19;
+
+
+int internalTime::gpsUtcOffset(long long utc)
+{
+	//branch free count of leap seconds passed
+	int count = 0;
+	for(int i = 0; i < numLeaps; ++i)
 	{
-		if ( (y%4 == 0) && (!(y%100 == 0)) )
-			isLeap = true;
+		count += (utc >= leapInstants[i]);
+	}
+	return 10 + count - taiGps;
+};
 
-		if ( (y%4 == 0) && (y%100 == 0) && (y%400 == 0) )
-			isLeap = true;
-		if(isLeap)
-			leapCount += 1;
+
+long long internalTime::utcToGPST(long long utc)
+{
+	return utc + gpsUtcOffset(utc);
+};
+
+
+long long internalTime::gpstToUTC(long long gpst)
+{
+	//leap second i is at GPS time leapInstants[i] + offset after it
+	int count = 0;
+	for(int i = 0; i < numLeaps; ++i)
+	{
+		count += (gpst >= leapInstants[i] + 10 + i + 1 - taiGps);
 	}
-	UNIXTime += leapCount * 24 * 60 * 60;
-	//This is standard UNIX internalTime without leap seconds
-	//Adding leap seconds
-	UNIX = UNIXTime + leapSeconds;
+	return gpst - (10 + count - taiGps);
+};
+
+
+long long internalTime::gstToGPST(long long gst)
+{
+	return gst;
+};
+
+
+long long internalTime::bdtToGPST(long long bdt)
+{
+	return bdt + 14;
+};
+
+
+long long internalTime::gpstToBDT(long long gpst)
+{
+	return gpst - 14;
+};
+
+
+long long internalTime::glonassToUTC(long long glot)
+{
+	return glot - 10800;
+};
+
+
+long long internalTime::utcToGLONASST(long long utc)
+{
+	return utc + 10800;
 };
 
+
+void internalTime::toWeekSeconds(long long t, long long origin, int& week, int& sow)
+{
+	long long dt = t - origin;
+	long long w = dt / 604800 - (dt % 604800 < 0);
+	week = w;
+	sow = dt - w * 604800;
+};
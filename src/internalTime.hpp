@@ -63,7 +63,8 @@ class internalTime
 	int hour;   //!< Stores hour as Integer
 	int minute; //!< Stores minute as Integer
 	int second; //!< Stores second as Integer
-	int UNIX;   //!< Stores Converted UNIX Time as Integer
+	int nanosecond; //!< Stores fraction of second in nanoseconds [0, 999999999]
+	long long UNIX;   //!< Stores Converted UNIX Time as 64-bit Integer (whole seconds)
 
 
 
@@ -95,6 +96,17 @@ class internalTime
 	void parse(std::string, std::string&);
 
 
+    //!Member function parseEpoch
+    /*!Member function parseEpoch sets internal values from a RINEX 3 observation
+     * epoch record ("> YYYY MM DD hh mm ss.sssssss"), using fixed columns 
+     * (A1,1X,I4,4(1X,I2.2),F11.7) without allocation.
+     * \param line pointer to first character of the line.
+     * \param len length of the line.
+     * \return Returns false if record is malformed.
+    */
+	bool parseEpoch(const char* line, int len);
+
+
     //!Member Function, providing UNIX time.
     /*!Member function, converting stored time to UNIX time.
     */
@@ -105,10 +117,85 @@ class internalTime
     
     void toUNIXTime(int); //sets corresponding UNIX internalTime + leapseconds
     
+    
+    //!Function to count days from civil date.
+    /*!This function returns number of days from 01/01/1970 to a date of proleptic 
+     * Gregorian calendar, in constant time.
+     * \param Y year(YYYY)
+     * \param M Month(MM)
+     * \param D Day(DD)
+     * \return Returns days since UNIX epoch (negative before 1970).
+    */
+    static long long daysFromCivil(int Y, int M, int D);
+    
+    
+    //! Number of nanoseconds in a second.
+    static const long long NANO = 1000000000LL;
+    
+    //!Member Function, providing UNIX time in nanoseconds.
+    /*!\return Returns @ref UNIX scaled to nanoseconds plus @ref nanosecond.
+    */
+    long long UNIXNano() const;
+    
+    
+    //! GPS time origin 06/01/1980 00:00:00 (GPST), as UNIX-style seconds.
+    static const long long GPS_EPOCH = 315964800LL;
+    //! BeiDou time origin 01/01/2006 00:00:00 (BDT), as UNIX-style seconds.
+    static const long long BDT_EPOCH = 1136073600LL;
+    
+    
+    //!Function to get GPS - UTC offset.
+    /*!This function returns GPS - UTC (leap seconds since 1980) at a UTC time, 
+     * from embedded leap second table (TAI - UTC changes up to 01/01/2017).
+     * \param utc UTC time (UNIX).
+     * \return Returns GPS - UTC in seconds.
+    */
+    static int gpsUtcOffset(long long utc);
+    
+    //!Function to convert UTC to GPS time.
+    /*!\param utc UTC time (UNIX).
+     * \return Returns GPS time as UNIX-style seconds of GPS calendar.
+    */
+    static long long utcToGPST(long long utc);
+    
+    //!Function to convert GPS time to UTC.
+    /*!\param gpst GPS time as UNIX-style seconds of GPS calendar.
+     * \return Returns UTC time (UNIX).
+    */
+    static long long gpstToUTC(long long gpst);
+    
+    //!Function to convert Galileo system time to GPS time (GST is aligned to GPST).
+    static long long gstToGPST(long long gst);
+    
+    //!Function to convert BeiDou time to GPS time (BDT = GPST - 14 s).
+    static long long bdtToGPST(long long bdt);
+    
+    //!Function to convert GPS time to BeiDou time.
+    static long long gpstToBDT(long long gpst);
+    
+    //!Function to convert GLONASS time (UTC(SU) + 3 hours) to UTC.
+    static long long glonassToUTC(long long glot);
+    
+    //!Function to convert UTC to GLONASS time (UTC(SU) + 3 hours).
+    static long long utcToGLONASST(long long utc);
+    
+    //!Function to split time in week number and seconds of week.
+    /*!\param t Time as UNIX-style seconds, in same time scale as origin.
+     * \param origin Time scale origin, e.g. @ref GPS_EPOCH or @ref BDT_EPOCH.
+     * \param week Output week number.
+     * \param sow Output seconds of week.
+    */
+    static void toWeekSeconds(long long t, long long origin, int& week, int& sow);
+    
     internalTime(); 
     /**< Default Constructor. 
      */
 
+  private:
+    
+    //! Splits seconds given as real number in whole seconds and nanoseconds.
+    void setSeconds(double s);
+
 };
 
 
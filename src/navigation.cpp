@@ -34,16 +34,27 @@
 #include <sstream>
 #include <exception>
 #include <cmath>
+#include <thread>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <memory>
 
 #include "navigation.hpp"
 #include "internalTime.hpp"
 #include "constants.hpp"
+#include "fieldParser.hpp"
+#include "ephemerisStore.hpp"
 
 navigation::navigation(std::vector<std::string> fnames)
 {
     // set filenames
     fileNames = fnames;
 
+    version = 0.0;
+    leapSeconds = 0;
+
     // allocate data structure
     ephemeris_G = { {},
                     {},
@@ -144,490 +155,415 @@ navigation::navigation(std::vector<std::string> fnames)
                     {} };
 };
 
+// Merge key of an ephemeris record
+static inline long long recordTime(const ephemerisGE& rec) { return rec.Toc; }
+static inline long long recordTime(const ephemerisR& rec) { return rec.tb; }
+
+
+
+// Sorts per-prn records by time and removes duplicates, of records with the
+// same time the one appended first is kept (files overlap at day boundaries).
+template <typename T>
+static void sortUnique(std::vector<std::vector<T> >& store)
+{
+    for(std::vector<T>& sat : store) {
+        std::stable_sort(sat.begin(), sat.end(),
+                         [](const T& a, const T& b) { return recordTime(a) < recordTime(b); });
+        sat.erase(std::unique(sat.begin(), sat.end(),
+                              [](const T& a, const T& b) { return recordTime(a) == recordTime(b); }),
+                  sat.end());
+    }
+}
+
+
+
+// Appends per-prn records of src to dst.
+template <typename T>
+static void appendRecords(std::vector<std::vector<T> >& dst, const std::vector<std::vector<T> >& src)
+{
+    for(size_t prn = 0; prn < src.size(); ++prn) {
+        dst[prn].insert(dst[prn].end(), src[prn].begin(), src[prn].end());
+    }
+}
+
+
+
+// Appends all records and header values of src to dst.
+static void appendNavigation(navigation& dst, const navigation& src)
+{
+    if(dst.version == 0.0)
+        dst.version = src.version;
+    if(dst.leapSeconds == 0)
+        dst.leapSeconds = src.leapSeconds;
+
+    appendRecords(dst.ephemeris_G, src.ephemeris_G);
+    appendRecords(dst.ephemeris_R, src.ephemeris_R);
+    appendRecords(dst.ephemeris_E, src.ephemeris_E);
+    appendRecords(dst.ephemeris_C, src.ephemeris_C);
+}
+
+
+
+// Sorts and de-duplicates all records of nav.
+static void sortUnique(navigation& nav)
+{
+    sortUnique(nav.ephemeris_G);
+    sortUnique(nav.ephemeris_R);
+    sortUnique(nav.ephemeris_E);
+    sortUnique(nav.ephemeris_C);
+}
+
+
+
 void navigation::read()
 {
-    std::ifstream navFile;
+    // Navigation files are grouped by daily store (see ephemerisStore). Files
+    // already merged in their store are not parsed, records are taken from the
+    // mapped store. Other files are parsed in parallel and merged into the store.
+    // If a merged file has changed, all files of its day are parsed and the
+    // store is rebuilt, so that records of the old file version are dropped.
+    std::vector<std::string> stores;
+    std::vector<int> fileStore(fileNames.size(), -1);
+    for(size_t i = 0; i < fileNames.size(); ++i) {
+        std::string name = ephemerisStore::storeName(fileNames[i]);
+        if(name.size() == 0)
+            continue;
+        size_t k = std::find(stores.begin(), stores.end(), name) - stores.begin();
+        if(k == stores.size())
+            stores.push_back(name);
+        fileStore[i] = k;
+    }
 
+    std::vector<std::unique_ptr<ephemerisStore> > mapped;
+    for(const std::string& name : stores) {
+        mapped.push_back(std::unique_ptr<ephemerisStore>(new ephemerisStore(name)));
+        mapped.back()->open();
+    }
+
+    std::vector<bool> rebuild(stores.size(), false);
+    for(size_t i = 0; i < fileNames.size(); ++i) {
+        if(fileStore[i] >= 0 && mapped[fileStore[i]]->hasChangedSource(fileNames[i]))
+            rebuild[fileStore[i]] = true;
+    }
+
+    std::vector<size_t> toParse;
+    for(size_t i = 0; i < fileNames.size(); ++i) {
+        if(fileStore[i] < 0 || rebuild[fileStore[i]] || !mapped[fileStore[i]]->hasSource(fileNames[i]))
+            toParse.push_back(i);
+    }
+
+    // Each navigation file is parsed into its own navigation object, files are
+    // independent so they are parsed in parallel, by at most one worker per
+    // hardware thread taking files from a shared counter.
+    std::vector<navigation> parts;
+    std::vector<int> status(toParse.size(), 0);
+    parts.reserve(toParse.size());
+    for(size_t i : toParse) {
+        parts.push_back(navigation(std::vector<std::string>(1, fileNames[i])));
+    }
+
+    int numTasks = parts.size();
+    std::atomic<int> next(0);
+    auto worker = [&]() {
+        for(int j = next++; j < numTasks; j = next++) {
+            status[j] = parts[j].readFile(fileNames[toParse[j]]);
+        }
+    };
+
+    int numThreads = std::min(int(std::thread::hardware_concurrency()), numTasks);
+    if(numThreads <= 1) {
+        worker();
+    } else {
+        std::vector<std::thread> workers;
+        for(int t = 0; t < numThreads; ++t) {
+            workers.push_back(std::thread(worker));
+        }
+        for(auto& w : workers) {
+            w.join();
+        }
+    }
+
+    for(size_t j = 0; j < parts.size(); ++j) {
+        if(status[j] != 0) {
+            std::cout << "Unable to open navigation file: " << fileNames[toParse[j]] << "\n";
+            std::cout << "Exiting with non-zero status !\n";
+            exit(-1);
+        }
+    }
+
+    // Merge each daily store with its newly parsed files, or rebuild it from
+    // all its parsed files, and write it back
+    for(size_t k = 0; k < stores.size(); ++k) {
+        navigation day(std::vector<std::string>(0));
+        std::vector<ephemerisStore::storeSource> sources;
+        bool changed = false;
+
+        if(!rebuild[k]) {
+            sources = mapped[k]->sources;
+            mapped[k]->load(day);
+        }
+        for(size_t j = 0; j < parts.size(); ++j) {
+            if(fileStore[toParse[j]] != int(k))
+                continue;
+            appendNavigation(day, parts[j]);
+            changed = true;
+
+            ephemerisStore::storeSource source;
+            if(ephemerisStore::sourceInfo(fileNames[toParse[j]], source)) {
+                // a changed file replaces its previous entry
+                for(size_t s = 0; s < sources.size(); ++s) {
+                    if(strncmp(sources[s].name, source.name, sizeof(source.name)) == 0) {
+                        sources.erase(sources.begin() + s);
+                        break;
+                    }
+                }
+                sources.push_back(source);
+            }
+        }
+
+        if(changed) {
+            sortUnique(day);
+            mapped[k].reset();
+            if(!ephemerisStore::write(stores[k], day, sources))
+                std::cout << "Unable to write navigation store: " << stores[k] << "\n";
+        }
+        appendNavigation(*this, day);
+    }
+
+    // Files without a store
+    for(size_t j = 0; j < parts.size(); ++j) {
+        if(fileStore[toParse[j]] < 0)
+            appendNavigation(*this, parts[j]);
+    }
+
+    sortUnique(*this);
+};
+
+
+
+int navigation::readFile(const std::string& fname)
+{
+    std::ifstream navFile;
     std::string line;
-    std::string str;
-    std::size_t pos;
+    double versionField;
+    int value;
+
+    navFile.open(fname);
+    if(!navFile.is_open()) {
+        return -1;
+    }
+
+    while(std::getline(navFile, line)) {
+        if(line.size() < 73) {
+            continue;
+        }
+        if(line.compare(60, 20, "RINEX VERSION / TYPE") == 0) {
+            // VERSION
+            if(fieldParser::toDouble(line.data(), line.size(), 0, 9, versionField))
+                version = versionField;
+            continue;
+        }
+        if(line.compare(60, 12, "LEAP SECONDS") == 0) {
+            // LEAP SECONDS
+            if(fieldParser::toInt(line.data(), line.size(), 0, 6, value))
+                leapSeconds = value;
+            continue;
+        }
+        if(line.compare(60, 13, "END OF HEADER") == 0) {
+            // END OF HEADER
+            break;
+        }
+    } // End of HEADER parsing
+
+    // Start reading data records, a single pass for all constellations
+    while(std::getline(navFile, line)) {
+        if(line.size() == 0) {
+            continue;
+        }
+        switch(line[0]) {
+        case 'G':
+            // GPS record
+            readRecordGE(navFile, line, 'G', ephemeris_G);
+            break;
+        case 'E':
+            // GALILEO record
+            readRecordGE(navFile, line, 'E', ephemeris_E);
+            break;
+        case 'C':
+            // BEIDOU record
+            readRecordGE(navFile, line, 'C', ephemeris_C);
+            break;
+        case 'R':
+            // GLONASS record
+            readRecordR(navFile, line);
+            break;
+        default:
+            // I dont want to process this line, orbit lines of other
+            // systems (SBAS, QZSS, IRNSS) start with blanks and fall here too
+            break;
+        }
+    } // END of FILE
+
+    // Closing Navigation File
+    navFile.close();
+    return 0;
+};
+
+
+
+bool navigation::readEpoch(const std::string& line, int& prn, long long& Toc)
+{
+    // SV / EPOCH / SV CLK  -->  A1,I2.2,1X,I4,5(1X,I2.2)
+    const char* p = line.data();
+    int len = line.size();
     internalTime epoch_time;
+
+    bool ok = fieldParser::toInt(p, len, 1, 2, prn);
+    ok = ok && fieldParser::toInt(p, len, 4, 4, epoch_time.year);
+    ok = ok && fieldParser::toInt(p, len, 9, 2, epoch_time.month);
+    ok = ok && fieldParser::toInt(p, len, 12, 2, epoch_time.day);
+    ok = ok && fieldParser::toInt(p, len, 15, 2, epoch_time.hour);
+    ok = ok && fieldParser::toInt(p, len, 18, 2, epoch_time.minute);
+    ok = ok && fieldParser::toInt(p, len, 21, 2, epoch_time.second);
+    if(!ok || epoch_time.month < 1 || epoch_time.month > 12) {
+        return false;
+    }
+
+    epoch_time.toUNIXTime();
+    Toc = epoch_time.UNIX;
+    return true;
+};
+
+
+
+bool navigation::readOrbit(std::istream& navFile, std::string& line, double* fields)
+{
+    // BROADCAST ORBIT - n  -->  4X,4D19.12
+    if(!std::getline(navFile, line)) {
+        return false;
+    }
+    const char* p = line.data();
+    int len = line.size();
+    bool ok = fieldParser::toDouble(p, len, 4, 19, fields[0]);
+    ok = fieldParser::toDouble(p, len, 23, 19, fields[1]) && ok;
+    ok = fieldParser::toDouble(p, len, 42, 19, fields[2]) && ok;
+    ok = fieldParser::toDouble(p, len, 61, 19, fields[3]) && ok;
+    return ok;
+};
+
+
+
+void navigation::readRecordGE(std::istream& navFile, std::string& line, char sys,
+                              std::vector<std::vector<ephemerisGE> >& store)
+{
+    int prn;
+    long long Toc;
+    bool ok = readEpoch(line, prn, Toc);
+
+    // Toc is kept in GPS time, BeiDou epochs are in BDT (GST is aligned to GPST)
+    if(sys == 'C') {
+        Toc = internalTime::bdtToGPST(Toc);
+    }
+
+    // Always consume ORBIT - 1 to 7 so that a bad record cannot
+    // shift the following ones
+    double orbit[7][4];
+    for(int n = 0; n < 7; ++n) {
+        ok = readOrbit(navFile, line, orbit[n]) && ok;
+    }
+
+    // cannot process this record, or prn is out of the supported range
+    if(!ok || prn < 1 || prn > int(store.size())) {
+        return;
+    }
+
+    // check if this is a duplicate record
+    if(store[prn - 1].size() != 0 && store[prn - 1].back().Toc == Toc) {
+        return;
+    }
+
     ephemerisGE datum_GE;
-    ephemerisR datum_R;
 
-    int lineNumber = 0;
-    int linecount = 0;
+    // set Toc
+    datum_GE.Toc = Toc;
+
+    // ORBIT - 1 (IODE not required!)
+    datum_GE.Crs = orbit[0][1];    // Crs (meters)
+    datum_GE.deltan = orbit[0][2]; // Delta n (radians/sec)
+    datum_GE.M0 = orbit[0][3];     // M0 (radians)
+
+    // ORBIT - 2
+    datum_GE.Cuc = orbit[1][0];   // Cuc (radians)
+    datum_GE.e = orbit[1][1];     // e Eccentricity
+    datum_GE.Cus = orbit[1][2];   // Cus (radians)
+    datum_GE.Ahalf = orbit[1][3]; // sqrt(A)
+
+    // ORBIT - 3
+    datum_GE.Toe = orbit[2][0];    // Time of Ephemeris (sec of GPS/GAL/BDT week)
+    datum_GE.Cic = orbit[2][1];    // Cic (radians)
+    datum_GE.Omega0 = orbit[2][2]; // OMEGA0 (radians)
+    datum_GE.Cis = orbit[2][3];    // Cis (radians)
+
+    // ORBIT - 4
+    datum_GE.i0 = orbit[3][0];       // i0 (radians)
+    datum_GE.Crc = orbit[3][1];      // Crc (meters)
+    datum_GE.w = orbit[3][2];        // omega argument of perigee (radians)
+    datum_GE.Omegadot = orbit[3][3]; // OMEGA DOT (radians/sec)
+
+    // ORBIT - 5 (codes on L2 ignored)
+    datum_GE.idot = orbit[4][0]; // IDOT (radians/sec)
+    datum_GE.week = orbit[4][2]; // GPS/GAL/BDT week # (to go with Toe)
+
+    // ORBIT - 6 and 7 are not required
+
+    // Now datum_GE is complete push based on prn
+    store[prn - 1].push_back(datum_GE);
+};
+
+
+
+void navigation::readRecordR(std::istream& navFile, std::string& line)
+{
     int prn;
+    long long tb;
+    bool ok = readEpoch(line, prn, tb);
 
-    for(auto fname : fileNames) {
-        navFile.open(fname);
+    // GLONASS epochs are in UTC, kept in GPS time. Header leap seconds are
+    // used if newer than the embedded leap second table.
+    tb += std::max(leapSeconds, internalTime::gpsUtcOffset(tb));
 
-        if(navFile.is_open()) {
-            while(std::getline(navFile, line)) {
-                ++lineNumber;
-                if(line[60] == 'R' && line[66] == 'V' && line[76] == 'T') {
-                    // VERSION
-                    version = stof(line);
-                    continue;
-                }
-                if(line[60] == 'L' && line[63] == 'P' && line[71] == 'S') {
-                    // LEAP SECONDS
-                    leapSeconds = stoi(line);
-                    continue;
-                }
-                if(line[60] == 'E' && line[64] == 'O' && line[67] == 'H') {
-                    // END OF HEADER
-                    break;
-                }
-            } // End of HEADER parsing
-
-            // Start reading data records
-            while(!navFile.eof()) {
-                std::getline(navFile, line);
-                ++lineNumber;
-
-                if(line[0] == 'G') {
-                    try {
-                        linecount = 0;
-                        // GPS record started
-                        str = line.substr(1, 3);
-                        prn = stoi(str);
-                        // get epoch time in UNIX
-                        str = line.substr(3);
-                        epoch_time.year = stoi(str, &pos);
-                        str = str.substr(pos);
-
-                        epoch_time.month = stoi(str, &pos);
-                        str = str.substr(pos);
-
-                        epoch_time.day = stoi(str, &pos);
-                        str = str.substr(pos);
-
-                        epoch_time.hour = stoi(str, &pos);
-                        str = str.substr(pos);
-
-                        epoch_time.minute = stoi(str, &pos);
-                        str = str.substr(pos);
-
-                        epoch_time.second = stoi(str, &pos);
-                        str = str.substr(pos);
-
-                        epoch_time.toUNIXTime();
-
-                        // check if this is a duplicate record
-                        if(ephemeris_G[prn - 1].size() != 0)
-                            if(ephemeris_G[prn - 1].back().Toc == epoch_time.UNIX) {
-                                // Do not process this record and
-                                // skip all lines ORBIT - 1 to 7
-                                std::getline(navFile, line);
-                                std::getline(navFile, line);
-                                std::getline(navFile, line);
-                                std::getline(navFile, line);
-                                std::getline(navFile, line);
-                                std::getline(navFile, line);
-                                std::getline(navFile, line);
-                                continue;
-                            }
-
-                        // set Toc
-                        datum_GE.Toc = epoch_time.UNIX;
-
-                        // Next Line ORBIT - 1
-                        std::getline(navFile, line);
-                        ++linecount;
-                        datum_GE.Crs = stof(line, &pos); // IODE not required!
-                        str = line.substr(pos);
-                        datum_GE.Crs = stof(str, &pos); // Crs (meters)
-                        str = str.substr(pos);
-                        datum_GE.deltan = stof(str, &pos); // Delta n (radians/sec)
-                        str = str.substr(pos);
-                        datum_GE.M0 = stof(str, &pos); // M0 (radians)
-
-                        // Next Line ORBIT - 2
-                        std::getline(navFile, line);
-                        ++linecount;
-                        datum_GE.Cuc = stof(line, &pos); // Cuc (radians)
-                        str = line.substr(pos);
-                        datum_GE.e = stof(str, &pos); // e Eccentricity
-                        str = str.substr(pos);
-                        datum_GE.Cus = stof(str, &pos); // Cus (radians)
-                        str = str.substr(pos);
-                        datum_GE.Ahalf = stof(str, &pos); // sqrt(A)
-
-                        // Next Line ORBIT - 3
-                        std::getline(navFile, line);
-                        ++linecount;
-                        datum_GE.Toe = stof(line, &pos); // Time of Ephemeris (sec of GPS week)
-                        str = line.substr(pos);
-                        datum_GE.Cic = stof(str, &pos); // Cic (radians)
-                        str = str.substr(pos);
-                        datum_GE.Omega0 = stof(str, &pos); // OMEGA0 (radians)
-                        str = str.substr(pos);
-                        datum_GE.Cis = stof(str, &pos); // Cis (radians)
-
-                        // Next Line ORBIT - 4
-                        std::getline(navFile, line);
-                        ++linecount;
-                        datum_GE.i0 = stof(line, &pos); // Time of Ephemeris (sec of GPS week)
-                        str = line.substr(pos);
-                        datum_GE.Crc = stof(str, &pos); // Cic (radians)
-                        str = str.substr(pos);
-                        datum_GE.w = stof(str, &pos); // omega argument of perigee (radians)
-                        str = str.substr(pos);
-                        datum_GE.Omegadot = stof(str, &pos); // OMEGA DOT (radians/sec)
-
-                        // Next Line ORBIT - 5
-                        std::getline(navFile, line);
-                        ++linecount;
-                        datum_GE.idot = stof(line, &pos); // IDOT (radians/sec)
-                        str = line.substr(pos);
-                        datum_GE.week = stof(str, &pos); // codes on L2 (Ignore)
-                        str = str.substr(pos);
-                        datum_GE.week = stof(str, &pos); // GPS/GAL week # (to go with Toe)
-
-                        // Now datum_GE is complete push based on prn
-                        ephemeris_G[prn - 1].push_back(datum_GE);
-
-                        // Skip remaining lines
-                        // Next Line ORBIT - 6
-                        std::getline(navFile, line);
-                        ++linecount;
-                        // Next Line ORBIT - 7
-                        std::getline(navFile, line);
-                        ++linecount;
-                    } catch(std::exception& e) {
-                        // cannot process this record, skip lines
-                        while(linecount != 7) {
-                            std::getline(navFile, line);
-                            ++linecount;
-                        }
-                    }
+    double orbit[3][4];
+    for(int n = 0; n < 3; ++n) {
+        ok = readOrbit(navFile, line, orbit[n]) && ok;
+    }
 
-                } else if(line[0] == 'R') {
-                    try {
-                        linecount = 0;
-                        // GLONASS record started
-                        str = line.substr(1, 3);
-                        prn = stoi(str);
-
-                        if(prn > 24) {
-                            // Do not process this record and
-                            // skip all lines
-                            std::getline(navFile, line);
-                            std::getline(navFile, line);
-                            std::getline(navFile, line);
-                            continue;
-                        }
-
-                        // get epoch time in UNIX
-                        str = line.substr(3);
-                        epoch_time.year = stoi(str, &pos);
-                        str = str.substr(pos);
-
-                        epoch_time.month = stoi(str, &pos);
-                        str = str.substr(pos);
-
-                        epoch_time.day = stoi(str, &pos);
-                        str = str.substr(pos);
-
-                        epoch_time.hour = stoi(str, &pos);
-                        str = str.substr(pos);
-
-                        epoch_time.minute = stoi(str, &pos);
-                        str = str.substr(pos);
-
-                        epoch_time.second = stoi(str, &pos);
-                        str = str.substr(pos);
-
-                        epoch_time.toUNIXTime();
-
-                        // Push reference epoch
-                        datum_R.tb = epoch_time.UNIX;
-
-                        // Next Line ORBIT - 1
-                        std::getline(navFile, line);
-                        ++linecount;
-                        datum_R.px = stof(line, &pos); // X Coordinate at te, in PZ-90 (Km)
-                        str = line.substr(pos);
-                        datum_R.vx = stof(str, &pos); // Velocity X component at te, in PZ-90 (Km / sec)
-                        str = str.substr(pos);
-                        datum_R.xdd = stof(str, &pos); // Sun and Moon acceleration X at te (Km / sec2)
-
-                        // Next Line ORBIT - 2
-                        std::getline(navFile, line);
-                        ++linecount;
-                        datum_R.py = stof(line, &pos); // Y Coordinate at te, in PZ-90 (Km)
-                        str = line.substr(pos);
-                        datum_R.vy = stof(str, &pos); // Velocity Y component at te, in PZ-90 (Km / sec)
-                        str = str.substr(pos);
-                        datum_R.ydd = stof(str, &pos); // Sun and Moon acceleration Y at te (Km / sec2)
-
-                        // Next Line ORBIT - 3
-                        ++linecount;
-                        std::getline(navFile, line);
-                        datum_R.pz = stof(line, &pos); // Z Coordinate at te, in PZ-90 (Km)
-                        str = line.substr(pos);
-                        datum_R.vz = stof(str, &pos); // Velocity Z component at te, in PZ-90 (Km / sec)
-                        str = str.substr(pos);
-                        datum_R.zdd = stof(str, &pos); // Sun and Moon acceleration Z at te (Km / sec2)
-                        // Push datum
-                        ephemeris_R[prn - 1].push_back(datum_R);
-                    } catch(std::exception& e) {
-                        // cannot process this record, skip lines
-                        while(linecount != 3) {
-                            std::getline(navFile, line);
-                            ++linecount;
-                        }
-                    }
+    // cannot process this record, or prn is out of the supported range
+    if(!ok || prn < 1 || prn > GLO_SIZE) {
+        return;
+    }
 
-                } else if(line[0] == 'E') {
-                    try {
-                        linecount = 0;
-                        // GALILEO record started
-                        str = line.substr(1, 3);
-                        prn = stoi(str);
-                        // get epoch time in UNIX
-                        str = line.substr(3);
-                        epoch_time.year = stoi(str, &pos);
-                        str = str.substr(pos);
-
-                        epoch_time.month = stoi(str, &pos);
-                        str = str.substr(pos);
-
-                        epoch_time.day = stoi(str, &pos);
-                        str = str.substr(pos);
-
-                        epoch_time.hour = stoi(str, &pos);
-                        str = str.substr(pos);
-
-                        epoch_time.minute = stoi(str, &pos);
-                        str = str.substr(pos);
-
-                        epoch_time.second = stoi(str, &pos);
-                        str = str.substr(pos);
-
-                        epoch_time.toUNIXTime();
-
-                        // check if this is a duplicate record
-                        if(ephemeris_E[prn - 1].size() != 0)
-                            if(ephemeris_E[prn - 1].back().Toc == epoch_time.UNIX) {
-                                // Do not process this record and
-                                // skip all lines ORBIT - 1 to 7
-                                std::getline(navFile, line);
-                                std::getline(navFile, line);
-                                std::getline(navFile, line);
-                                std::getline(navFile, line);
-                                std::getline(navFile, line);
-                                std::getline(navFile, line);
-                                std::getline(navFile, line);
-                                continue;
-                            }
-
-                        // set Toc
-                        datum_GE.Toc = epoch_time.UNIX;
-
-                        // Next Line ORBIT - 1
-                        std::getline(navFile, line);
-                        ++linecount;
-                        datum_GE.Crs = stof(line, &pos); // IODE not required!
-                        str = line.substr(pos);
-                        datum_GE.Crs = stof(str, &pos); // Crs (meters)
-                        str = str.substr(pos);
-                        datum_GE.deltan = stof(str, &pos); // Delta n (radians/sec)
-                        str = str.substr(pos);
-                        datum_GE.M0 = stof(str, &pos); // M0 (radians)
-
-                        // Next Line ORBIT - 2
-                        std::getline(navFile, line);
-                        ++linecount;
-                        datum_GE.Cuc = stof(line, &pos); // Cuc (radians)
-                        str = line.substr(pos);
-                        datum_GE.e = stof(str, &pos); // e Eccentricity
-                        str = str.substr(pos);
-                        datum_GE.Cus = stof(str, &pos); // Cus (radians)
-                        str = str.substr(pos);
-                        datum_GE.Ahalf = stof(str, &pos); // sqrt(A)
-
-                        // Next Line ORBIT - 3
-                        std::getline(navFile, line);
-                        ++linecount;
-                        datum_GE.Toe = stof(line, &pos); // Time of Ephemeris (sec of GPS week)
-                        str = line.substr(pos);
-                        datum_GE.Cic = stof(str, &pos); // Cic (radians)
-                        str = str.substr(pos);
-                        datum_GE.Omega0 = stof(str, &pos); // OMEGA0 (radians)
-                        str = str.substr(pos);
-                        datum_GE.Cis = stof(str, &pos); // Cis (radians)
-
-                        // Next Line ORBIT - 4
-                        std::getline(navFile, line);
-                        ++linecount;
-                        datum_GE.i0 = stof(line, &pos); // Time of Ephemeris (sec of GPS week)
-                        str = line.substr(pos);
-                        datum_GE.Crc = stof(str, &pos); // Cic (radians)
-                        str = str.substr(pos);
-                        datum_GE.w = stof(str, &pos); // omega argument of perigee (radians)
-                        str = str.substr(pos);
-                        datum_GE.Omegadot = stof(str, &pos); // OMEGA DOT (radians/sec)
-
-                        // Next Line ORBIT - 5
-                        std::getline(navFile, line);
-                        ++linecount;
-                        datum_GE.idot = stof(line, &pos); // IDOT (radians/sec)
-                        str = line.substr(pos);
-                        datum_GE.week = stof(str, &pos); // codes on L2 (Ignore)
-                        str = str.substr(pos);
-                        datum_GE.week = stof(str, &pos); // GPS/GAL week # (to go with Toe)
-
-                        // Now datum_GE is complete push based on prn
-                        ephemeris_E[prn - 1].push_back(datum_GE);
-
-                        // Skip remaining lines
-                        // Next Line ORBIT - 6
-                        std::getline(navFile, line);
-                        ++linecount;
-                        // Next Line ORBIT - 7
-                        std::getline(navFile, line);
-                        ++linecount;
-                    } catch(std::exception& e) {
-                        // cannot process this record, skip lines
-                        while(linecount != 7) {
-                            std::getline(navFile, line);
-                            ++linecount;
-                        }
-                    }
+    ephemerisR datum_R;
 
-                } else if(line[0] == 'C') {
-                    try {
-                        linecount = 0;
-                        // BEIDOU record started
-                        str = line.substr(1, 3);
-                        prn = stoi(str);
-                        // get epoch time in UNIX
-                        str = line.substr(3);
-                        epoch_time.year = stoi(str, &pos);
-                        str = str.substr(pos);
-
-                        epoch_time.month = stoi(str, &pos);
-                        str = str.substr(pos);
-
-                        epoch_time.day = stoi(str, &pos);
-                        str = str.substr(pos);
-
-                        epoch_time.hour = stoi(str, &pos);
-                        str = str.substr(pos);
-
-                        epoch_time.minute = stoi(str, &pos);
-                        str = str.substr(pos);
-
-                        epoch_time.second = stoi(str, &pos);
-                        str = str.substr(pos);
-
-                        epoch_time.toUNIXTime();
-
-                        // check if this is a duplicate record
-                        if(ephemeris_C[prn - 1].size() != 0)
-                            if(ephemeris_C[prn - 1].back().Toc == epoch_time.UNIX) {
-                                // Do not process this record and
-                                // skip all lines ORBIT - 1 to 7
-                                std::getline(navFile, line);
-                                std::getline(navFile, line);
-                                std::getline(navFile, line);
-                                std::getline(navFile, line);
-                                std::getline(navFile, line);
-                                std::getline(navFile, line);
-                                std::getline(navFile, line);
-                                continue;
-                            }
-
-                        // set Toc
-                        datum_GE.Toc = epoch_time.UNIX;
-
-                        // Next Line ORBIT - 1
-                        std::getline(navFile, line);
-                        ++linecount;
-                        datum_GE.Crs = stof(line, &pos); // IODE not required!
-                        str = line.substr(pos);
-                        datum_GE.Crs = stof(str, &pos); // Crs (meters)
-                        str = str.substr(pos);
-                        datum_GE.deltan = stof(str, &pos); // Delta n (radians/sec)
-                        str = str.substr(pos);
-                        datum_GE.M0 = stof(str, &pos); // M0 (radians)
-
-                        // Next Line ORBIT - 2
-                        std::getline(navFile, line);
-                        ++linecount;
-                        datum_GE.Cuc = stof(line, &pos); // Cuc (radians)
-                        str = line.substr(pos);
-                        datum_GE.e = stof(str, &pos); // e Eccentricity
-                        str = str.substr(pos);
-                        datum_GE.Cus = stof(str, &pos); // Cus (radians)
-                        str = str.substr(pos);
-                        datum_GE.Ahalf = stof(str, &pos); // sqrt(A)
-
-                        // Next Line ORBIT - 3
-                        std::getline(navFile, line);
-                        ++linecount;
-                        datum_GE.Toe = stof(line, &pos); // Time of Ephemeris (sec of BDT week)
-                        str = line.substr(pos);
-                        datum_GE.Cic = stof(str, &pos); // Cic (radians)
-                        str = str.substr(pos);
-                        datum_GE.Omega0 = stof(str, &pos); // OMEGA0 (radians)
-                        str = str.substr(pos);
-                        datum_GE.Cis = stof(str, &pos); // Cis (radians)
-
-                        // Next Line ORBIT - 4
-                        std::getline(navFile, line);
-                        ++linecount;
-                        datum_GE.i0 = stof(line, &pos); // i0 (radians)
-                        str = line.substr(pos);
-                        datum_GE.Crc = stof(str, &pos); // Cic (meters)
-                        str = str.substr(pos);
-                        datum_GE.w = stof(str, &pos); // omega argument of perigee (radians)
-                        str = str.substr(pos);
-                        datum_GE.Omegadot = stof(str, &pos); // OMEGA DOT (radians/sec)
-
-                        // Next Line ORBIT - 5
-                        std::getline(navFile, line);
-                        ++linecount;
-                        datum_GE.idot = stof(line, &pos); // IDOT (radians/sec)
-                        str = line.substr(pos);
-                        datum_GE.week = stof(str, &pos); // codes on L2 (Ignore)
-                        str = str.substr(pos);
-                        datum_GE.week = stof(str, &pos); // GPS/GAL/BDT week # (to go with Toe)
-
-                        // Now datum_GE is complete push based on prn
-                        ephemeris_C[prn - 1].push_back(datum_GE);
-
-                        // Skip remaining lines
-                        // Next Line ORBIT - 6
-                        std::getline(navFile, line);
-                        ++linecount;
-                        // Next Line ORBIT - 7
-                        std::getline(navFile, line);
-                        ++linecount;
-                    } catch(std::exception& e) {
-                        // cannot process this record, skip lines
-                        while(linecount != 7) {
-                            std::getline(navFile, line);
-                            ++linecount;
-                        }
-                    }
+    // Push reference epoch
+    datum_R.tb = tb;
 
-                } else {
-                    // I dont want to process this line
-                    continue;
-                }
-            } // END of FILE
-        } else {
-            std::cout << "Unable to open navigation file: " << fname << "\n";
-            std::cout << "Exiting with non-zero status !\n";
-            exit(-1);
-        }
+    // ORBIT - 1
+    datum_R.px = orbit[0][0];  // X Coordinate at te, in PZ-90 (Km)
+    datum_R.vx = orbit[0][1];  // Velocity X component at te, in PZ-90 (Km / sec)
+    datum_R.xdd = orbit[0][2]; // Sun and Moon acceleration X at te (Km / sec2)
+
+    // ORBIT - 2
+    datum_R.py = orbit[1][0];  // Y Coordinate at te, in PZ-90 (Km)
+    datum_R.vy = orbit[1][1];  // Velocity Y component at te, in PZ-90 (Km / sec)
+    datum_R.ydd = orbit[1][2]; // Sun and Moon acceleration Y at te (Km / sec2)
+
+    // ORBIT - 3
+    datum_R.pz = orbit[2][0];  // Z Coordinate at te, in PZ-90 (Km)
+    datum_R.vz = orbit[2][1];  // Velocity Z component at te, in PZ-90 (Km / sec)
+    datum_R.zdd = orbit[2][2]; // Sun and Moon acceleration Z at te (Km / sec2)
 
-        // Closing Navigation File
-        navFile.close();
-    } // END of for loop over file names
+    // Push datum
+    ephemeris_R[prn - 1].push_back(datum_R);
 };
 
 
@@ -774,8 +710,9 @@ void navigation::getPositionGE(ephemerisGE& initial, int t , triple& pos)
 
     // Compute the true anomaly vk
     // using Ek computed in previous step and e eccentricity fron nav epoch record
-    float vk = atan((sqrt(1 - initial.e * initial.e) * 
-                    sin(Ek)) / (cos(Ek) - initial.e));
+    // (atan2 keeps the quadrant of vk)
+    float vk = atan2(sqrt(1 - initial.e * initial.e) * sin(Ek), 
+                     cos(Ek) - initial.e);
 
     // Compute the argument of latitude
     // from: the argument of perigee (w) (fron nav epoch record),
@@ -942,44 +879,261 @@ void navigation::applyRotations(float& Lk, float& ik, float& uk,
 
 
 
-// This routine has some precision problem !
+int navigation::findEphemerisGE(const std::vector<ephemerisGE>& records, long long t)
+{
+    // first record with Toc >= t, the one before it is the latest with Toc < t
+    int lo = 0;
+    int hi = records.size();
+    while(lo < hi) {
+        int mid = (lo + hi) / 2;
+        if(records[mid].Toc < t)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if(lo == 0 || t - records[lo - 1].Toc > 7200) //2 hours
+        return -1;
+    return lo - 1;
+};
+
+
+
+int navigation::findEphemerisR(const std::vector<ephemerisR>& records, long long t)
+{
+    // first record with tb >= t, nearest is either this or the previous one
+    int lo = 0;
+    int hi = records.size();
+    while(lo < hi) {
+        int mid = (lo + hi) / 2;
+        if(records[mid].tb < t)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    int best = -1;
+    long long bestDiff = 1800 + 1; //30 minutes, GLONASS ephemerides are updated every 30 minutes
+    if(lo < int(records.size()) && records[lo].tb - t < bestDiff) {
+        best = lo;
+        bestDiff = records[lo].tb - t;
+    }
+    if(lo > 0 && t - records[lo - 1].tb < bestDiff) {
+        best = lo - 1;
+    }
+    return best;
+};
+
+
+
+bool navigation::satPosition(char sys, int prn, long long t, triple& pos)
+{
+    int n;
+    long long tk;
+    switch(sys) {
+    case 'G':
+        if(prn < 1 || prn > GPS_SIZE)
+            return false;
+        n = findEphemerisGE(ephemeris_G[prn - 1], t);
+        if(n < 0)
+            return false;
+        tk = elapsedFromToe(ephemeris_G[prn - 1][n], t, internalTime::GPS_EPOCH);
+        getPositionGE(ephemeris_G[prn - 1][n], ephemeris_G[prn - 1][n].Toe + int(tk), pos);
+        return true;
+    case 'E':
+        if(prn < 1 || prn > GAL_SIZE)
+            return false;
+        n = findEphemerisGE(ephemeris_E[prn - 1], t);
+        if(n < 0)
+            return false;
+        // Galileo week in RINEX is aligned to GPS week
+        tk = elapsedFromToe(ephemeris_E[prn - 1][n], internalTime::gstToGPST(t), internalTime::GPS_EPOCH);
+        getPositionGE(ephemeris_E[prn - 1][n], ephemeris_E[prn - 1][n].Toe + int(tk), pos);
+        return true;
+    case 'C':
+        if(prn < 1 || prn > BDU_SIZE)
+            return false;
+        n = findEphemerisGE(ephemeris_C[prn - 1], t);
+        if(n < 0)
+            return false;
+        tk = elapsedFromToe(ephemeris_C[prn - 1][n], internalTime::gpstToBDT(t), internalTime::BDT_EPOCH);
+        if(prn <= 5) {
+            // BeiDou GEO satellites C01 - C05
+            getPositionGEO(ephemeris_C[prn - 1][n], ephemeris_C[prn - 1][n].Toe + int(tk), pos);
+        } else {
+            getPositionGE(ephemeris_C[prn - 1][n], ephemeris_C[prn - 1][n].Toe + int(tk), pos);
+        }
+        return true;
+    case 'R':
+        if(prn < 1 || prn > GLO_SIZE)
+            return false;
+        n = findEphemerisR(ephemeris_R[prn - 1], t);
+        if(n < 0)
+            return false;
+        propagateR(ephemeris_R[prn - 1][n], int(t - ephemeris_R[prn - 1][n].tb), pos);
+        return true;
+    default:
+        return false;
+    }
+};
+
+
+
+long long navigation::elapsedFromToe(const ephemerisGE& record, long long t, long long origin)
+{
+    // tk = t - (week, Toe), both in the time scale of origin
+    return t - origin - (long long)record.week * 604800 - record.Toe;
+};
+
+
+
+// GLONASS equations of motion in PZ-90 (Km, Km/sec), as in getPositionR,
+// y = (x, y, z, vx, vy, vz), acc = Sun and Moon accelerations
+static void derivativeR(const double* y, const double* acc, double* dy)
+{
+    double r2 = y[0] * y[0] + y[1] * y[1] + y[2] * y[2];
+    double r = sqrt(r2);
+    double mu_r3 = -1 * mu_PZ90 / (r2 * r);
+    double c20mu = 1.5 * C20_PZ90 * mu_PZ90 * aE_PZ90 * aE_PZ90 / (r2 * r2 * r);
+    double z2_5r2 = 5.0 * y[2] * y[2] / r2;
+    double w3_2 = wE * wE;
+    double w3t2 = wE * 2.0;
+
+    dy[0] = y[3];
+    dy[1] = y[4];
+    dy[2] = y[5];
+    dy[3] = (mu_r3 * y[0]) + (c20mu * y[0] * (1.0 - z2_5r2)) + w3_2 * y[0] + w3t2 * y[4] + acc[0];
+    dy[4] = (mu_r3 * y[1]) + (c20mu * y[1] * (1.0 - z2_5r2)) + w3_2 * y[1] - w3t2 * y[3] + acc[1];
+    dy[5] = (mu_r3 * y[2]) + (c20mu * y[2] * (3.0 - z2_5r2)) + acc[2];
+}
+
+
+
+void navigation::propagateR(const ephemerisR& initialConditions, int dt, triple& pos)
+{
+    double y[6] = { initialConditions.px, initialConditions.py, initialConditions.pz,
+                    initialConditions.vx, initialConditions.vy, initialConditions.vz };
+    double acc[3] = { initialConditions.xdd, initialConditions.ydd, initialConditions.zdd };
+    double k1[6], k2[6], k3[6], k4[6], tmp[6];
+
+    // Runge-Kutta 4th order with steps of at most 60 seconds
+    int steps = (std::abs(dt) + 59) / 60;
+    for(int s = 0; s < steps; ++s) {
+        double h = double(dt) / steps;
+        derivativeR(y, acc, k1);
+        for(int i = 0; i < 6; ++i)
+            tmp[i] = y[i] + 0.5 * h * k1[i];
+        derivativeR(tmp, acc, k2);
+        for(int i = 0; i < 6; ++i)
+            tmp[i] = y[i] + 0.5 * h * k2[i];
+        derivativeR(tmp, acc, k3);
+        for(int i = 0; i < 6; ++i)
+            tmp[i] = y[i] + h * k3[i];
+        derivativeR(tmp, acc, k4);
+        for(int i = 0; i < 6; ++i)
+            y[i] += h * (k1[i] + 2.0 * k2[i] + 2.0 * k3[i] + k4[i]) / 6.0;
+    }
+
+    // Km to meters
+    pos.X = y[0] * 1000.0;
+    pos.Y = y[1] * 1000.0;
+    pos.Z = y[2] * 1000.0;
+};
+
+
+
+void navigation::getPositionGEO(ephemerisGE& initial, int t, triple& pos)
+{
+    // BeiDou GEO satellites, BDS-SIS-ICD-2.0 section 5.2.4.12
+    double tk = t - initial.Toe;
+    if(tk > 302400) {
+        tk = tk - 604800;
+    } else if(tk < -302400) {
+        tk = tk + 604800;
+    }
+
+    double A = double(initial.Ahalf) * initial.Ahalf;
+    double Mk = initial.M0 + (sqrt(mu_WGS84 / (A * A * A)) + initial.deltan) * tk;
+    double Ek = eccAnomaly(Mk, initial.e);
+    double vk = atan2(sqrt(1 - initial.e * initial.e) * sin(Ek), cos(Ek) - initial.e);
+    double phik = vk + initial.w;
+    double s2 = sin(2 * phik);
+    double c2 = cos(2 * phik);
+
+    double uk = phik + initial.Cus * s2 + initial.Cuc * c2;
+    double rk = A * (1 - initial.e * cos(Ek)) + initial.Crs * s2 + initial.Crc * c2;
+    double ik = initial.i0 + initial.idot * tk + initial.Cis * s2 + initial.Cic * c2;
+    double xk = rk * cos(uk);
+    double yk = rk * sin(uk);
+
+    // ascending node in inertial frame (no Earth rotation since Toe)
+    double Lk = initial.Omega0 + initial.Omegadot * tk - wE * initial.Toe;
+    double XG = xk * cos(Lk) - yk * cos(ik) * sin(Lk);
+    double YG = xk * sin(Lk) + yk * cos(ik) * cos(Lk);
+    double ZG = yk * sin(ik);
+
+    // pos = Rz(wE * tk) Rx(-5 deg) (XG, YG, ZG)
+    double c5 = cos(-5.0 * toRadians);
+    double s5 = sin(-5.0 * toRadians);
+    double Y1 = c5 * YG + s5 * ZG;
+    double Z1 = -s5 * YG + c5 * ZG;
+    double cz = cos(wE * tk);
+    double sz = sin(wE * tk);
+
+    pos.X = cz * XG + sz * Y1;
+    pos.Y = -sz * XG + cz * Y1;
+    pos.Z = Z1;
+};
+
+
+
+// Closed-form conversion by Vermeille, H. "Direct transformation from
+// geocentric coordinates to geodetic coordinates", Journal of Geodesy (2002) 76:451-454.
+// Exact (non-iterative) for all points outside the evolute of the ellipsoid,
+// i.e. everything farther than ~43 km from the center of the Earth.
 void navigation::ecefToEllipsoidal(const triple& ecef, triple& ellipsoid)
 {
-	double phi0 = 0.0;
-	double h0 = 0.0;
-	double p = sqrt(ecef.X * ecef.X + ecef.Y * ecef.Y);
-	double Ni;
-	double change_phi;
-	double change_h;
-    
-    //eccentricity squared of elipse cross-section
-    double e2 = 1.0 - ( (b_WGS84 * b_WGS84) / (a_WGS84 * a_WGS84) );  
+    ecefToEllipsoidal(&ecef.X, &ecef.Y, &ecef.Z, &ellipsoid.X, &ellipsoid.Y, &ellipsoid.Z, 1);
+};
 
-	int iter = 0;
-    
-    //Calculation of Longitude (East) in degrees
-	ellipsoid.Y = (atan(ecef.Y/ecef.X) * toDegrees) + 360.0;  
 
-	//calculate phi(Latitude) by iterative method
-	//first set initial values
-	phi0 = atan( ecef.Z / ( ( 1.0 - e2 ) * p ) );
-	
-	do
-	{
-		iter += 1;
-		Ni = a_WGS84 / sqrt( 1.0 - e2 * sin(phi0) * sin(phi0));
-		ellipsoid.Z = ( p / cos(phi0) ) - Ni;
-		ellipsoid.X = atan( ecef.Z / ( ( 1.0 - e2 * ( Ni / ( Ni + ellipsoid.Z ) ) ) * p ) );
-		change_phi = abs( ( (ecef.X - phi0) / ecef.X ) * 100.0 );
-		change_h = abs( ( (ellipsoid.Z - h0) / ellipsoid.Z ) * 100.0 );
-		phi0 = ecef.X;
-		h0 = ellipsoid.Z;
-	}
-	while(change_phi > 0.0000005 || change_h > 0.0000005);
-    
-    //Latitude in degrees
-    ellipsoid.X = ellipsoid.X * toDegrees;
 
+void navigation::ecefToEllipsoidal(const double* X, const double* Y, const double* Z,
+                                   double* lat, double* lon, double* h, int n)
+{
+    //eccentricity squared of elipse cross-section
+    const double e2 = 1.0 - ( (b_WGS84 * b_WGS84) / (a_WGS84 * a_WGS84) );
+    const double e4 = e2 * e2;
+    const double a2inv = 1.0 / (a_WGS84 * a_WGS84);
+    const double deg = toDegrees;
+
+    // Straight loop over SoA coordinates, no branches or iterations
+    for(int i = 0; i < n; ++i)
+    {
+        double w2 = X[i] * X[i] + Y[i] * Y[i];
+        double w = sqrt(w2);
+
+        double p = w2 * a2inv;
+        double q = (1.0 - e2) * a2inv * Z[i] * Z[i];
+        double r = (p + q - e4) / 6.0;
+        double s = e4 * p * q / (4.0 * r * r * r);
+        double t = cbrt(1.0 + s + sqrt(s * (2.0 + s)));
+        double u = r * (1.0 + t + 1.0 / t);
+        double v = sqrt(u * u + e4 * q);
+        double uv = u + v;
+        double wv = e2 * (uv - q) / (2.0 * v);
+        double k = sqrt(uv + wv * wv) - wv;
+        double D = k * w / (k + e2);
+        double Dz = sqrt(D * D + Z[i] * Z[i]);
+
+        //Latitude in degrees
+        lat[i] = 2.0 * atan2(Z[i], D + Dz) * deg;
+
+        //Longitude (East) in degrees, in range [0, 360)
+        double lambda = atan2(Y[i], X[i]) * deg;
+        lon[i] = lambda + (lambda < 0.0 ? 360.0 : 0.0);
+
+        //Height above ellipsoid in meters
+        h[i] = (k + e2 - 1.0) / k * Dz;
+    }
 };
 
 
@@ -1072,12 +1226,6 @@ int navigation::computeIPP(const triple& marker, const triple& sat, const double
 	//magnitude of line of sight
 	double mag_los = sqrt( (los.X * los.X) + (los.Y * los.Y) + (los.Z * los.Z) );
 	
-	//Direction Unit vector for los
-	triple d_los;
-	d_los.X = los.X / mag_los;
-	d_los.X = los.Y / mag_los;
-	d_los.X = los.Z / mag_los;
-	
 
 	//The solutions to this quadratic are described by:
 	// ( -b +- sqrt( b*b -4*a*c ) ) / 2*a
@@ -1116,14 +1264,14 @@ int navigation::computeIPP(const triple& marker, const triple& sat, const double
 	{
 		u1 = ( (-1 * b) + sqrt(eb) ) / (2 * a);
 		u2 = ( (-1 * b) - sqrt(eb) ) / (2 * a);
-		// calculate both points
-		vec_u1.X = d_los.X * u1;
-		vec_u1.Y = d_los.Y * u1;
-		vec_u1.Z = d_los.Z * u1;
-
-		vec_u2.X = d_los.X * u2;
-		vec_u2.Y = d_los.Y * u2;
-		vec_u2.Z = d_los.Z * u2;
+		// calculate both points, u is parameter along los (a = |los|^2)
+		vec_u1.X = los.X * u1;
+		vec_u1.Y = los.Y * u1;
+		vec_u1.Z = los.Z * u1;
+
+		vec_u2.X = los.X * u2;
+		vec_u2.Y = los.Y * u2;
+		vec_u2.Z = los.Z * u2;
 		// to both solutions add marker vector to obtain ipp from origin
 		vec_u1.X += mx;
 		vec_u1.Y += my;
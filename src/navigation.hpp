@@ -32,6 +32,8 @@
 
 #include "internalTime.hpp"
 #include <vector>
+#include <string>
+#include <istream>
 #include "ephemerisGE.hpp"
 #include "ephemerisR.hpp"
 
@@ -50,10 +52,22 @@ class navigation
 public:
     //!Member function read
     /*!Member function read parses input navigation files and constructs
-        * internal navigation structure.
+        * internal navigation structure. Files already merged in their daily
+        * @ref ephemerisStore are loaded from the store, other files are parsed
+        * in parallel, each by @ref readFile, and merged into the store. Records
+        * are sorted by time and de-duplicated.
         */
     void read();
 
+    //!Member function readFile
+    /*!Member function readFile parses a single navigation file in one pass,
+        * storing records of all constellations. Orbit lines are converted
+        * using fixed columns (4X,4D19.12) by @ref fieldParser.
+        * \param fname Navigation file name.
+        * \return Returns 0 on success, -1 if file cannot be opened.
+        */
+    int readFile(const std::string& fname);
+
     //!Constructor with Input files
     /*!Constructs navigation object by reading input navigation files
         * defined by fnames.
@@ -97,14 +111,105 @@ public:
 
 
 
+    //!Function to select ephemeris record for a given time.
+    /*!This function selects the latest record of a satellite for which
+        * \f$ 0 < t - Toc \le 7200 \f$ seconds, records are sorted by Toc so a binary
+        * search is used.
+        * \param records Time sorted ephemeris records of a satellite.
+        * \param t Time (UNIX) for which ephemeris is required.
+        * \return Returns index of selected record, or -1 if none is valid.
+        */
+    int findEphemerisGE(const std::vector<ephemerisGE>& records, long long t);
+
+
+
+    //!Function to select GLONASS ephemeris record for a given time.
+    /*!This function selects the record of a satellite with nearest tb, 
+        * within 30 minutes of t.
+        * \param records Time sorted ephemeris records of a satellite.
+        * \param t Time (UNIX) for which ephemeris is required.
+        * \return Returns index of selected record, or -1 if none is valid.
+        */
+    int findEphemerisR(const std::vector<ephemerisR>& records, long long t);
+
+
+
+    //!Function to compute satellite position at a given time.
+    /*!This function computes ECEF position of a satellite at a given time, selecting
+        * the ephemeris record to use. GPS/Galileo/BeiDou positions are computed
+        * from Keplerian elements, GLONASS positions by @ref propagateR.
+        * \param sys Satellite system ('G','R','E','C').
+        * \param prn Satellite prn.
+        * \param t Time (GPST, as UNIX-style seconds) for which position is required.
+        * \param pos Output ECEF cartesian coordinates (meters).
+        * \return Returns false if no valid ephemeris is available.
+        */
+    bool satPosition(char sys, int prn, long long t, triple& pos);
+
+
+
+    //!Function to compute time from ephemeris reference epoch.
+    /*!This function computes tk from week number and Toe of a record, with 
+        * integer arithmetic.
+        * \param record Ephemeris record.
+        * \param t Time in the time scale of the record (GPST, GST or BDT) as UNIX-style seconds.
+        * \param origin Origin of the week numbering, internalTime::GPS_EPOCH or internalTime::BDT_EPOCH.
+        * \return Returns tk in seconds.
+        */
+    static long long elapsedFromToe(const ephemerisGE& record, long long t, long long origin);
+
+
+
+    //!Function to propagate GLONASS satellite position.
+    /*!This function integrates GLONASS equations of motion from initial conditions
+        * at tb over dt seconds, using Runge-Kutta 4th order with steps of at most 60 seconds.
+        * \param initialConditions ephemerisR object containing initial conditions.
+        * \param dt Integer time from tb in seconds (may be negative).
+        * \param pos triple object returned with computed coordinates (meters).
+        */
+    void propagateR(const ephemerisR& initialConditions, int dt, triple& pos);
+
+
+
+    //!Function to compute BeiDou GEO satellite positions.
+    /*!This function calculates BeiDou GEO (C01 - C05) satellite coordinates given
+        * an ephemerisGE object and time for which coordinates are required. Orbit is 
+        * computed in an inertial frame and then rotated by -5 degrees about X and by
+        * Earth rotation since Toe.
+        * \param initial ephemerisGE object containing initial Keplerian elements.
+        * \param t Integer time for which coordinates are to be computed.
+        * \param pos triple object returned with computed coordinates.
+        */
+    void getPositionGEO(ephemerisGE& initial, int t, triple& pos);
+
+
+
     //!Function to convert ECEF to ellipsoidal coordinates.
     /*!This function converts ECEF cartesian coordinates \f$ (x,y,z) \f$ to
-         * ellipsoidal coordinates \f$ (\varphi,\lambda,h) \f$ respectively lattitude, 
-         * longitude, and height. 
+        * ellipsoidal coordinates \f$ (\varphi,\lambda,h) \f$ respectively lattitude, 
+        * longitude, and height. Latitude and longitude are in degrees, longitude 
+        * in range [0, 360). Conversion is closed-form (Vermeille), non-iterative.
         * \param ecef ECEF cartesian coordinates.
         * \param ellipsoid Output ellipsoidal coordinates \f$ (\varphi,\lambda,h) \f$ .
         */
-    void ecefToEllipsoidal(const triple& ecef, triple& ellipsoid);
+    static void ecefToEllipsoidal(const triple& ecef, triple& ellipsoid);
+
+
+
+    //!Function to convert a batch of ECEF coordinates to ellipsoidal coordinates.
+    /*!Batch version of @ref ecefToEllipsoidal working over structure of arrays.
+        * Coordinates are converted one by one with the closed-form expressions, without
+        * branches or iterations.
+        * \param X Array of ECEF X coordinates.
+        * \param Y Array of ECEF Y coordinates.
+        * \param Z Array of ECEF Z coordinates.
+        * \param lat Output array of latitudes (degrees).
+        * \param lon Output array of longitudes (degrees).
+        * \param h Output array of heights (meters).
+        * \param n Number of coordinates.
+        */
+    static void ecefToEllipsoidal(const double* X, const double* Y, const double* Z,
+                                  double* lat, double* lon, double* h, int n);
 
     
     
@@ -156,6 +261,44 @@ private:
         * Hidden, cannot be used.
         */
 
+    //!Function to parse SV / EPOCH / SV CLK line.
+    /*!This function parses prn and epoch (as UNIX time) of a navigation record.
+        * \param line Record first line.
+        * \param prn Output satellite prn.
+        * \param Toc Output epoch in UNIX time.
+        * \return Returns false if line cannot be parsed.
+        */
+    bool readEpoch(const std::string& line, int& prn, long long& Toc);
+
+    //!Function to read and parse a BROADCAST ORBIT line.
+    /*!This function reads next line from navFile into line and parses its
+        * four D19.12 fields.
+        * \param navFile Input navigation file stream.
+        * \param line Line buffer, reused across calls.
+        * \param fields Output array of four values.
+        * \return Returns false if line is missing or cannot be parsed.
+        */
+    bool readOrbit(std::istream& navFile, std::string& line, double* fields);
+
+    //!Function to read a GPS/Galileo/BeiDou record.
+    /*!This function parses a Keplerian record (epoch line and 7 orbit lines) and
+        * pushes it to store, invalid or duplicate records are skipped.
+        * \param navFile Input navigation file stream.
+        * \param line Record first line, reused as line buffer.
+        * \param sys Satellite system of the record ('G','E','C').
+        * \param store Ephemeris store of the constellation.
+        */
+    void readRecordGE(std::istream& navFile, std::string& line, char sys,
+                      std::vector<std::vector<ephemerisGE> >& store);
+
+    //!Function to read a GLONASS record.
+    /*!This function parses a GLONASS record (epoch line and 3 orbit lines) and
+        * pushes it to @ref ephemeris_R, invalid records are skipped.
+        * \param navFile Input navigation file stream.
+        * \param line Record first line, reused as line buffer.
+        */
+    void readRecordR(std::istream& navFile, std::string& line);
+
     //!Function to compute eccentricity anomaly Ek.
     /*!This Function computes eccentricity anomaly Ek by Solving (iteratively) 
         * the Kepler equation for the eccentricity anomaly, using 
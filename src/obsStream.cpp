@@ -0,0 +1,195 @@
+/*
+    GTEC -  A high performance standardized implementation of 
+    Multi Constellation GNSS Derived TEC Calibration 
+    (Model by T/ICT4D Lab ICTP).
+    Copyright (C) 2016,2017  Muhammad Owais
+    
+    This file is part of GTEC.
+
+    GTEC is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    GTEC is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with GTEC.  If not, see <http://www.gnu.org/licenses/>.
+    
+    Disclaimer: GTEC is a research implementation which is under 
+    development and should not be considered fully functional unless 
+    otherwise stated or a release is announced. Author is providing this 
+    software on a best effort AS IS basis and do not warrant validity, 
+    functionality, and suitability for any particular purpose. All copyright 
+    notices must be kept intact. 
+
+*/
+
+
+
+
+
+#include "obsStream.hpp"
+#include "ObsData.hpp"
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <time.h>
+
+
+//Monotonic clock in milliseconds, not affected by changes of system time
+static long long monotonicMillis()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000LL + ts.tv_nsec / 1000000;
+}
+
+
+obsStream::obsStream(ObsData& odata, std::string fname, int idleTimeout)
+{
+    od = &odata;
+    this->fname = fname;
+    headerRead = false;
+    finished = false;
+    fileFd = -1;
+    offset = 0;
+    lineNumber = 0;
+    epochCounter = 0;
+    skipEpoch = false;
+    this->idleTimeout = idleTimeout;
+    lastData = monotonicMillis();
+    
+    //watch directory, file may not exist yet
+    std::size_t slash = fname.find_last_of('/');
+    std::string dir = (slash == std::string::npos) ? "." : fname.substr(0, slash + 1);
+    
+    notifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    watchFd = (notifyFd < 0) ? -1 : inotify_add_watch(notifyFd, dir.c_str(), IN_MODIFY | IN_CREATE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE);
+    if(watchFd < 0)
+    {
+        std::cout << "Unable to watch observation directory: " << dir << "\n";
+        std::cout << "Exiting with non-zero status !\n";
+        exit(-1);
+    }
+};
+
+
+obsStream::~obsStream()
+{
+    if(fileFd >= 0)
+        close(fileFd);
+    close(notifyFd);
+};
+
+
+int obsStream::poll(int timeout)
+{
+    std::size_t slash = fname.find_last_of('/');
+    std::string base = (slash == std::string::npos) ? fname : fname.substr(slash + 1);
+    
+    struct pollfd pfd;
+    pfd.fd = notifyFd;
+    pfd.events = POLLIN;
+    ::poll(&pfd, 1, timeout);
+    
+    //drain events, only rename or removal of our file changes state, other events just mean "read again"
+    //(writer closing file does not, loggers may reopen it for each epoch)
+    bool ended = false;
+    char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t len;
+    while((len = read(notifyFd, buffer, sizeof(buffer))) > 0)
+    {
+        for(char* p = buffer; p < buffer + len; p += sizeof(struct inotify_event) + ((struct inotify_event*) p)->len)
+        {
+            const struct inotify_event* event = (const struct inotify_event*) p;
+            if(event->len > 0 && base == event->name && (event->mask & (IN_MOVED_FROM | IN_DELETE)))
+                ended = true;
+        }
+    }
+    
+    //bytes left in renamed or removed file are still read through open descriptor
+    bool wasFinished = finished;
+    long long before = offset;
+    int lines = ingest();
+    long long now = monotonicMillis();
+    if(offset != before)
+        lastData = now;
+    if(ended || (idleTimeout > 0 && now - lastData >= idleTimeout * 1000LL))
+        finished = true;
+    
+    //no more satellite lines will come for last epoch
+    if(finished && !wasFinished && epochCounter != 0 && !skipEpoch)
+        od->closeEpoch();
+    
+    return lines;
+};
+
+
+int obsStream::ingest()
+{
+    if(fileFd < 0)
+    {
+        fileFd = open(fname.c_str(), O_RDONLY | O_CLOEXEC);
+        if(fileFd < 0)
+            return 0;
+    }
+    
+    //read appended bytes
+    char buffer[65536];
+    ssize_t len;
+    while((len = pread(fileFd, buffer, sizeof(buffer), offset)) > 0)
+    {
+        pending.append(buffer, len);
+        offset += len;
+    }
+    
+    //split complete lines, Header lines are kept till Header is complete
+    std::string records;
+    std::size_t start = 0;
+    std::size_t end;
+    int lines = 0;
+    while((end = pending.find('\n', start)) != std::string::npos)
+    {
+        std::size_t n = end - start;
+        if(n > 0 && pending[end - 1] == '\r')
+            n -= 1;
+        lines += 1;
+        if(headerRead)
+        {
+            records.append(pending, start, n);
+            records += '\n';
+        }
+        else
+        {
+            header.append(pending, start, n);
+            header += '\n';
+            if(n >= 73 && pending.compare(start + 60, 13, "END OF HEADER") == 0)
+            {
+                std::istringstream hs(header);
+                int headerLines = 0;
+                headerRead = od->readHeader(hs, headerLines);
+                lineNumber += headerLines;
+                header.clear();
+            }
+        }
+        start = end + 1;
+    }
+    pending.erase(0, start);
+    
+    if(!records.empty())
+    {
+        std::istringstream rs(records);
+        od->readRecords(rs, fname, lineNumber, epochCounter, skipEpoch);
+        //stream ending with newline gives one extra empty line
+        lineNumber -= 1;
+    }
+    return lines;
+};
@@ -0,0 +1,111 @@
+/*
+    GTEC -  A high performance standardized implementation of 
+    Multi Constellation GNSS Derived TEC Calibration 
+    (Model by T/ICT4D Lab ICTP).
+    Copyright (C) 2016,2017  Muhammad Owais
+    
+    This file is part of GTEC.
+
+    GTEC is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    GTEC is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with GTEC.  If not, see <http://www.gnu.org/licenses/>.
+    
+    Disclaimer: GTEC is a research implementation which is under 
+    development and should not be considered fully functional unless 
+    otherwise stated or a release is announced. Author is providing this 
+    software on a best effort AS IS basis and do not warrant validity, 
+    functionality, and suitability for any particular purpose. All copyright 
+    notices must be kept intact. 
+
+*/
+
+
+
+
+
+#ifndef __OBS_STREAM__
+#define __OBS_STREAM__
+
+#include <string>
+
+class ObsData;
+
+
+/**
+ * @class obsStream
+ * @author Muhammad Owais
+ * @date 19/10/26
+ * @file obsStream.hpp
+ * @brief Class defining streaming ingestion of a growing observation file.
+ * 
+ * This Class follows a RINEX observation file which is still being appended by 
+ * a logger, and feeds new complete lines to an @ref ObsData object, using
+ * ObsData::readHeader once Header is complete and ObsData::readRecords for
+ * records. Directory of the file is watched with inotify, so that file may be 
+ * created after the stream and no polling of file size is needed. Partial lines
+ * at end of file are kept until their newline arrives.
+ * 
+ * Last epoch in @ref ObsData is left open (not zero padded) while streaming,
+ * as further satellite lines of it may still arrive. Writer may close and reopen
+ * the file any number of times. Stream ends when file is renamed or removed 
+ * (e.g. rotation by logger), after bytes left in it are read, or when no data
+ * arrived for idle timeout.
+ */
+class obsStream
+{
+  public:
+    
+    //!Constructor with observation object and file name.
+    /*!Starts watching directory of the file, does not read anything yet.
+     * @param odata Observation object to fill, epoch filter should be already set.
+     * @param fname Observation file name.
+     * @param idleTimeout Seconds without new data ending the stream, 0 waits for ever.
+     */
+    obsStream(ObsData& odata, std::string fname, int idleTimeout = 0);
+    
+    ~obsStream();
+    
+    //!Function to wait for and ingest new data.
+    /*!Waits up to timeout for file events, then reads all bytes appended since 
+     * last call and passes complete lines to @ref ObsData.
+     * @param timeout Maximum wait in milliseconds (0 does not wait).
+     * @return Returns number of lines ingested.
+     */
+    int poll(int timeout);
+    
+    
+    std::string fname;   //!< Observation file name
+    bool headerRead;     //!< Flag to indicate whether Header has been read
+    bool finished;       //!< Flag to indicate that stream ended (file renamed or removed, or idle timeout), last epoch is then closed too
+    int idleTimeout;     //!< Seconds without new data ending the stream, 0 waits for ever
+    
+  private:
+    
+    obsStream(); //!< default hidden Constructor
+    obsStream(const obsStream&); //!< hidden copy Constructor
+    
+    //! Reads bytes appended to file and ingests complete lines.
+    int ingest();
+    
+    ObsData* od;         //!< Observation object being filled
+    int notifyFd;        //!< inotify descriptor
+    int watchFd;         //!< Watch descriptor of file directory
+    int fileFd;          //!< Descriptor of observation file, -1 until it exists
+    long long offset;    //!< Bytes of file already read
+    std::string pending; //!< Partial line at end of file
+    std::string header;  //!< Header lines, until "END OF HEADER" arrives
+    int lineNumber;      //!< Lines read, for messages
+    int epochCounter;    //!< Epochs kept, see ObsData::readRecords
+    bool skipEpoch;      //!< Last epoch skipped, see ObsData::readRecords
+    long long lastData;  //!< Monotonic time (milliseconds) when data last arrived, or of construction
+};
+
+#endif
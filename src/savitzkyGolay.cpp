@@ -0,0 +1,149 @@
+/*
+    GTEC -  A high performance standardized implementation of 
+    Multi Constellation GNSS Derived TEC Calibration 
+    (Model by T/ICT4D Lab ICTP).
+    Copyright (C) 2016,2017  Muhammad Owais
+    
+    This file is part of GTEC.
+
+    GTEC is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    GTEC is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with GTEC.  If not, see <http://www.gnu.org/licenses/>.
+    
+    Disclaimer: GTEC is a research implementation which is under 
+    development and should not be considered fully functional unless 
+    otherwise stated or a release is announced. Author is providing this 
+    software on a best effort AS IS basis and do not warrant validity, 
+    functionality, and suitability for any particular purpose. All copyright 
+    notices must be kept intact. 
+
+*/
+
+#include "savitzkyGolay.hpp"
+#include <cmath>
+#include <algorithm>
+
+
+savitzkyGolay::savitzkyGolay()
+{
+    halfWindow = 3;
+    order = 1;
+    computeCoeffs();
+};
+
+savitzkyGolay::savitzkyGolay(int halfWindow, int order)
+{
+    this->halfWindow = halfWindow;
+    this->order = order;
+    computeCoeffs();
+};
+
+int savitzkyGolay::window() const
+{
+    return 2 * halfWindow + 1;
+};
+
+void savitzkyGolay::computeCoeffs()
+{
+    int n = window();
+    int m = order + 1;
+    coeffs.assign(n * n, 0.0f);
+    std::vector<double> M(m * m);
+    std::vector<double> b(m);
+    std::vector<double> u(m);
+
+    for(int t = 0; t < n; ++t)
+        {
+            //normal equations of polynomial in (x - t) over other epochs of window,
+            //abscissa scaled by window length to keep powers in range
+            std::fill(M.begin(), M.end(), 0.0);
+            for(int x = 0; x < n; ++x)
+                {
+                    if(x == t)
+                        continue;
+                    double d = double(x - t) / n;
+                    u[0] = 1.0;
+                    for(int a = 1; a < m; ++a)
+                        u[a] = u[a - 1] * d;
+                    for(int a = 0; a < m; ++a)
+                        for(int c = 0; c < m; ++c)
+                            M[a * m + c] += u[a] * u[c];
+                }
+
+            //value at t is constant term, solve M b = e0 (gauss elimination with partial pivoting)
+            std::fill(b.begin(), b.end(), 0.0);
+            b[0] = 1.0;
+            for(int k = 0; k < m; ++k)
+                {
+                    int pivot = k;
+                    for(int r = k + 1; r < m; ++r)
+                        if(std::fabs(M[r * m + k]) > std::fabs(M[pivot * m + k]))
+                            pivot = r;
+                    if(pivot != k)
+                        {
+                            for(int c = 0; c < m; ++c)
+                                std::swap(M[k * m + c], M[pivot * m + c]);
+                            std::swap(b[k], b[pivot]);
+                        }
+                    for(int r = k + 1; r < m; ++r)
+                        {
+                            double f = M[r * m + k] / M[k * m + k];
+                            for(int c = k; c < m; ++c)
+                                M[r * m + c] -= f * M[k * m + c];
+                            b[r] -= f * b[k];
+                        }
+                }
+            for(int k = m - 1; k >= 0; --k)
+                {
+                    for(int c = k + 1; c < m; ++c)
+                        b[k] -= M[k * m + c] * b[c];
+                    b[k] /= M[k * m + k];
+                }
+
+            //weight of each epoch is fitted polynomial of e0 row evaluated there
+            for(int x = 0; x < n; ++x)
+                {
+                    if(x == t)
+                        continue;
+                    double d = double(x - t) / n;
+                    double w = 0.0;
+                    double power = 1.0;
+                    for(int a = 0; a < m; ++a)
+                        {
+                            w += b[a] * power;
+                            power *= d;
+                        }
+                    coeffs[t * n + x] = w;
+                }
+        }
+};
+
+float savitzkyGolay::estimate(const float* s, const float* e, const float* p) const
+{
+    int n = window();
+    if(e - s < n)
+        return *p;
+
+    //window start, shifted inside arc near its ends
+    const float* w = p - halfWindow;
+    if(w < s)
+        w = s;
+    else if(w + n > e)
+        w = e - n;
+
+    const float* c = coeffs.data() + (p - w) * n;
+    float sum = 0.0f;
+    for(int k = 0; k < n; ++k)
+        {
+            sum += c[k] * w[k];
+        }
+    return sum;
+};
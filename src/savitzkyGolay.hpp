@@ -0,0 +1,86 @@
+/*
+    GTEC -  A high performance standardized implementation of 
+    Multi Constellation GNSS Derived TEC Calibration 
+    (Model by T/ICT4D Lab ICTP).
+    Copyright (C) 2016,2017  Muhammad Owais
+    
+    This file is part of GTEC.
+
+    GTEC is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    GTEC is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with GTEC.  If not, see <http://www.gnu.org/licenses/>.
+    
+    Disclaimer: GTEC is a research implementation which is under 
+    development and should not be considered fully functional unless 
+    otherwise stated or a release is announced. Author is providing this 
+    software on a best effort AS IS basis and do not warrant validity, 
+    functionality, and suitability for any particular purpose. All copyright 
+    notices must be kept intact. 
+
+*/
+
+
+
+
+
+#ifndef __SAVITZKY_GOLAY__
+#define __SAVITZKY_GOLAY__
+
+#include <vector>
+
+
+/**
+ * @class savitzkyGolay
+ * @author Muhammad Owais
+ * @date 19/10/26
+ * @file savitzkyGolay.hpp
+ * @brief Class defining Savitzky-Golay estimation of an epoch from its neighbours.
+ * 
+ * This Class Defines a fixed window of 2*halfWindow+1 epochs, and for each position in
+ * window the convolution coefficients giving value of least squares polynomial (of given
+ * order) fitted to other epochs of window, at that position. Coefficients are computed
+ * once, so that estimating a value is a single dot product over window without allocation.
+ * Position at centre of window is used inside an arc, other positions near its ends.
+ */
+class savitzkyGolay
+{
+  public:
+
+    //!Default filter, half window 3 and order 1 (mean of 3 previous and 3 next epochs inside arc).
+    savitzkyGolay();
+
+    //!Constructor.
+    /*!\param halfWindow Number of epochs on each side of centre (1-MAX_SG_HALF_WINDOW).
+     * \param order Order of fitted polynomial (0-MAX_SG_ORDER), less than 2*halfWindow.
+     */
+    savitzkyGolay(int halfWindow, int order);
+
+    int window() const; //!< Returns number of epochs in window
+
+    //!Function to estimate a value from its neighbours.
+    /*!Window is centred at p, and shifted to stay in [s, e) near ends of arc.
+     * \param s Pointer to first value of arc.
+     * \param e Pointer after last value of arc.
+     * \param p Pointer to value to estimate.
+     * \return Returns estimate of *p, or *p itself if arc is shorter than window.
+     */
+    float estimate(const float* s, const float* e, const float* p) const;
+
+    int halfWindow; //!< Number of epochs on each side of centre
+    int order;      //!< Order of fitted polynomial
+    std::vector<float> coeffs; //!< window() x window() coefficients, row for each position (own weight 0)
+
+  private:
+
+    void computeCoeffs();
+};
+
+#endif
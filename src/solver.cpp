@@ -31,7 +31,9 @@
 
 #include "solver.hpp"
 #include "triple.hpp"
+#include "geometry.hpp"
 #include <cmath>
+#include <limits>
 
 //Constructor with system options
 solver::solver(ObsData& odata, navigation& ndata, inout& in, 
@@ -45,6 +47,9 @@ solver::solver(ObsData& odata, navigation& ndata, inout& in,
   nd = &ndata;
   inp = &in;
   igrfm = &igrfModel;
+  
+  A = NULL;
+  B = NULL;
 };
 
 
@@ -60,6 +65,9 @@ solver::solver(ObsData& odata, navigation& ndata, inout& in, igrf& igrfModel)
   nd = &ndata;
   inp = &in;
   igrfm = &igrfModel;
+  
+  A = NULL;
+  B = NULL;
 };
 
 
@@ -67,8 +75,10 @@ solver::solver(ObsData& odata, navigation& ndata, inout& in, igrf& igrfModel)
 void solver::buildB()
 {
     //Build B
-    B = (double*) calloc(od->size_of_S * od->numArcs, sizeof(double));
-    for(int i=0; i < od->size_of_S; ++i)
+    //S holds only values between istart and iend, which may be less than size_of_S
+    int nS = S.size();
+    B = (double*) calloc(nS * od->numArcs, sizeof(double));
+    for(int i=0; i < nS; ++i)
     {
         B[ i*(od->numArcs) + S_arcnum[i] ] = 1.0;
     }
@@ -82,6 +92,28 @@ void solver::cleanUp()
   //cleanUp workspace
   free(B);
   free(A);
+  B = NULL;
+  A = NULL;
+};
+
+
+
+void solver::solveEpochs(int first, int last)
+{
+    //drop previous system
+    cleanUp();
+    S.clear();
+    SdimVec.clear();
+    OffSetVec.clear();
+    S_arcnum.clear();
+    S_prn.clear();
+    
+    //restrict system to given epochs and build it again
+    od->istart = first;
+    od->iend = last;
+    buildS(inp->samplingTime);
+    buildB();
+    buildA(inp->numCoeffs);
 };
 
 
@@ -89,182 +121,87 @@ void solver::cleanUp()
 
 void solver::buildS(int& samplingtime)
 {
-    od->numArcs = od->intse.size();
+    od->numArcs = od->arcs.size();
     int i,j;
-    float* tmptr = NULL;
+    char sys;
+    int prn;
     int ecount = 0;
     //number of epochs in sampling time
-    int nepochs_st = (samplingtime * 60) / od->interval;  
-    int st = 0; //nth sampling time
+    int nepochs_st = (samplingtime * 60 * internalTime::NANO) / od->interval;  
 
-    int Sstart = 0;
     int id = 0;
     int Scount = 0; //value count in vector S
     int numBlocks = 0; //sampling block count
     
-    int timeDiff;
-    triple satXYZ;
-    triple satLatLon;
-    triple ippXYZ;
-    triple ippLatLon;
-    triple markerLatLon;
-    double zenith;
-    
-    double xA;        
-    double yA;
-    double dt;
     double PI2 = 2.0 * M_PI;
     double varFactor = PI2 / 86400;
+    double NaN = std::numeric_limits<double>::quiet_NaN();
     
-    int stStart = od->timeline_main[od->istart];            // valid first epoch
-    int tMid;
-    bool evenOdd = ( ( nepochs_st % 2) == 0 );
-    int tOffSet = (nepochs_st - 1) / 2;
-    int tOffSet1 = (nepochs_st / 2);
-    int tOffSet2 = (nepochs_st / 2) - 1;
+    //Satellite positions and time from sampling block mid time, for each value in S.
+    //Geometry is computed for all of them in one batch once S is built.
+    std::vector<double> satX;
+    std::vector<double> satY;
+    std::vector<double> satZ;
+    std::vector<double> dtMid;
+    triple satXYZ;
     
+    //Mid time of sampling block is taken from its first epoch, so that it is defined
+    //for a last partial block and does not move with epochs missing in the block
+    long long tMid = 0; //nanoseconds
+    long long halfBlock = (long long)(nepochs_st - 1) * od->interval / 2;
     
-    if ( evenOdd )
-    {
-      tMid = ( od->timeline_main[od->istart + tOffSet1] +
-               od->timeline_main[od->istart + tOffSet2] ) / 2;
-    }
-    else
+    SdimbMax = 0;
+    
+    if ( od->istart < od->iend )
     {
-      tMid = od->timeline_main[od->istart + tOffSet];
+      tMid = od->timeline_main[od->istart] + halfBlock;
     }
     
-    for(i = od->istart; i < od->iend; ++i)
+    //push a value of S with its arc number, prn ID and satellite position
+    auto pushValue = [&](float value, int arcnum, char sys, int prn, long long t)
     {
-        ecount += 1;
-        //use this as index across all prn to get data for ith epoch
-        id = 0;
-        for (auto arc : od->GPS_ucTEC)
-        {
-            id +=1;
-            for (j=0; j< od->numArcs; ++j)
-            {
-                if( od->prnid[j] == id )
-                {
-                    if(i >= od->intse[j].start && i <= od->intse[j].end )
-                    {
-                        //Now this value is a non zero and belongs to 
-                        //jth arc_Number and jth prn_id
-                        //push this info in respective vectors
-                        S.push_back(arc[i]);
-                        //arc numbers start from zero '0'
-                        S_arcnum.push_back(j);
-                        //prn IDs are in the range [1-120]G32+R24+E30+C34
-                        S_prn.push_back(id);
-			
-			
-			//Get position
-			for(int n=0; n < nd->ephemeris_G[id-1].size() - 1 ; ++n)
-			{
-			  timeDiff =  od->timeline_main[i] - 
-				      nd->ephemeris_G[id-1][n].Toc;
-			  if ( timeDiff > 0 && timeDiff <= 7200) //2 hours
-			  {
-			    nd->getPositionGE(nd->ephemeris_G[id-1][n], 
-					      timeDiff, 
-					      satXYZ);
-                            //convert satXYZ to Lat/Long
-                            nd->ecefToEllipsoidal(satXYZ, satLatLon);
-                            //Compute IPP and coschi
-                            nd->computeIPP(od->MarkerPosition, satXYZ, inp->rh, ippXYZ, zenith);    
-                            //convert ippXYZ to Lat/Long
-                            nd->ecefToEllipsoidal(ippXYZ, ippLatLon);
-                            //convert ippXYZ to Lat/Long
-                            nd->ecefToEllipsoidal(od->MarkerPosition, markerLatLon);
-                            
-                            xA = ippLatLon.Y - markerLatLon.Y + 
-                                 varFactor * ((od->timeline_main[i] - tMid)/60);
-                                 
-                            igrfm->getMODIP(ippLatLon);
-			  }
-              
-			}
-			
-			
-			
-                    }
-                }
-            }
-        }        
+        S.push_back(value);
+        //arc numbers start from zero '0'
+        S_arcnum.push_back(arcnum);
+        //prn IDs are in the range [1-120]G32+R24+E30+C34
+        S_prn.push_back(id);
         
-        for (auto arc : od->GLO_ucTEC)
+        if( nd->satPosition(sys, prn, t / internalTime::NANO, satXYZ) )
         {
-            id +=1;
-            for (j=0; j< od->numArcs; ++j)
-            {
-                if( od->prnid[j] == id )
-                {
-                    if(i >= od->intse[j].start && i <= od->intse[j].end )
-                    {
-                        //Now this value is a non zero and belongs to 
-                        //jth arc_Number and jth prn_id
-                        //push this info in respective vectors
-                        S.push_back(arc[i]);
-                        //arc numbers start from zero '0'
-                        S_arcnum.push_back(j);
-                        //prn IDs are in the range [1-120]G32+R24+E30+C34
-                        S_prn.push_back(id);
-                    }
-                }
-            }
-        }       
-        
-        for (auto arc : od->GAL_ucTEC)
+            satX.push_back(satXYZ.X);
+            satY.push_back(satXYZ.Y);
+            satZ.push_back(satXYZ.Z);
+        }
+        else
         {
-            id +=1;
-            for (j=0; j< od->numArcs; ++j)
-            {
-                if( od->prnid[j] == id )
-                {
-                    if(i >= od->intse[j].start && i <= od->intse[j].end )
-                    {
-                        //Now this value is a non zero and belongs to 
-                        //jth arc_Number and jth prn_id
-                        //push this info in respective vectors
-                        S.push_back(arc[i]);
-                        //arc numbers start from zero '0'
-                        S_arcnum.push_back(j);
-                        //prn IDs are in the range [1-120]G32+R24+E30+C34
-                        S_prn.push_back(id);
-                    }
-                }
-            }
-        }   
-        
-        for (auto arc : od->BDU_ucTEC)
+            satX.push_back(NaN);
+            satY.push_back(NaN);
+            satZ.push_back(NaN);
+        }
+        dtMid.push_back(double(t - tMid) / internalTime::NANO);
+    };
+    
+    for(i = od->istart; i < od->iend; ++i)
+    {
+        ecount += 1;
+        //arcs are ordered by satellite, so values of ith epoch are
+        //pushed in satellite order, one arc per satellite at most
+        for (j=0; j< od->numArcs; ++j)
         {
-            id +=1;
-            for (j=0; j< od->numArcs; ++j)
+            if(i >= od->arcs.start[j] && i < od->arcs.end[j] )
             {
-                if( od->prnid[j] == id )
-                {
-                    if(i >= od->intse[j].start && i <= od->intse[j].end )
-                    {
-                        //Now this value is a non zero and belongs to 
-                        //jth arc_Number and jth prn_id
-                        //push this info in respective vectors
-                        S.push_back(arc[i]);
-                        //arc numbers start from zero '0'
-                        S_arcnum.push_back(j);
-                        //prn IDs are in the range [1-120]G32+R24+E30+C34
-                        S_prn.push_back(id);
-                    }
-                }
+                //Now this value belongs to jth arc_Number
+                //push this info in respective vectors
+                id = od->arcs.sat[j] + 1;
+                const float* arc = od->satSeries(od->arcs.sat[j], sys, prn)->data();
+                pushValue(arc[i], j, sys, prn, od->timeline_main[i]);
             }
         }
         
         if(ecount == nepochs_st)
         {
-           
-/*          //Done for this Sampling time reset variables
-            st += 1;//increment sampling time counter 0 is the 1st sampling time
-            ecount = 0; //reset epoch counter
-            Sstart = S.size();*/
+            //Done for this Sampling time reset epoch counter
+            ecount = 0;
             
             SdimVec.push_back( S.size() - Scount );
             OffSetVec.push_back( Scount );
@@ -276,16 +213,10 @@ void solver::buildS(int& samplingtime)
             numBlocks += 1;
             
             
-            // set stStart and tMid
-            stStart = od->timeline_main[i+1];               // the next epoch
-            if (evenOdd)
-	    {
-                tMid = (od->timeline_main[(i+1) + tOffSet1] +
-			od->timeline_main[(i+1) + tOffSet2]) / 2;
-            }
-            else
-	    {
-                tMid = od->timeline_main[(i+1) + tOffSet];
+            // set tMid for the next sampling block (if it has epochs)
+            if ((i+1) < od->iend)
+            {
+                tMid = od->timeline_main[i+1] + halfBlock;
             }
             
         }
@@ -293,6 +224,36 @@ void solver::buildS(int& samplingtime)
     }
     
     
+    //Compute elevation, azimuth, IPP and obliquity for all values in one batch
+    int nS = S.size();
+    S_elev.resize(nS);
+    S_azim.resize(nS);
+    S_ippLat.resize(nS);
+    S_ippLon.resize(nS);
+    S_obliq.resize(nS);
+    
+    geometry geo(od->MarkerPosition, od->MarkerEllipsoidal, inp->rh);
+    geo.compute(satX.data(), satY.data(), satZ.data(), nS,
+                S_elev.data(), S_azim.data(), S_ippLat.data(), S_ippLon.data(), S_obliq.data());
+    
+    //Local time like coordinate of IPP with respect to station, at sampling block mid time
+    S_x.resize(nS);
+    double markerLon = od->MarkerEllipsoidal.Y;
+    for(int k = 0; k < nS; ++k)
+    {
+        double dLon = S_ippLon[k] - markerLon;
+        dLon += (dLon > 180.0 ? -360.0 : 0.0) + (dLon <= -180.0 ? 360.0 : 0.0);
+        S_x[k] = dLon * toRadians + varFactor * dtMid[k];
+    }
+    
+    //MODIP of IPP with respect to station
+    S_y.resize(nS);
+    igrfm->getMODIP(S_ippLat.data(), S_ippLon.data(), S_y.data(), nS);
+    double stationMODIP = igrfm->getStationMODIP(od->MarkerEllipsoidal);
+    for(int k = 0; k < nS; ++k)
+    {
+        S_y[k] -= stationMODIP;
+    }
 };
 
 
@@ -305,7 +266,21 @@ void solver::buildA(int numCoeffs)
         //Allocate A
         A = (double*) malloc( S.size() * numCoeffs * sizeof(double) );
         
-         
+        //vTECeq polynomial 1, x, y, x^2, xy, y^2 mapped to slant by obliquity
+        int nS = S.size();
+        for(int i = 0; i < nS; ++i)
+        {
+            double x = S_x[i];
+            double y = S_y[i];
+            double f = S_obliq[i];
+            double* row = A + i * numCoeffs;
+            row[0] = f;
+            row[1] = f * x;
+            row[2] = f * y;
+            row[3] = f * x * x;
+            row[4] = f * x * y;
+            row[5] = f * y * y;
+        }
     }
     else if (numCoeffs == 9)
     {
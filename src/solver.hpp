@@ -101,7 +101,10 @@ class solver
 
         //!Stores matrix A.
         /*!This is stored matrix A. A stores the data for vTECeq polynomial
-         * representation using 6 or 9 coefficients.
+         * representation using 6 or 9 coefficients. Row \f$ i \f$ holds polynomial 
+         * terms of @ref S_x and @ref S_y for \f$ i^{th} \f$ value in S, multiplied by
+         * obliquity @ref S_obliq. Size of A is ( @ref size_of_S \f$ x \f$ numCoeffs ),
+         * row major. Rows of values without ephemeris are NaN.
          */
         double* A;
 
@@ -142,6 +145,47 @@ class solver
         std::vector<int> S_prn;
         
 	
+	//! Stores satellite elevation for @ref S.
+        /*! This vector stores for each element in @ref S , satellite elevation (radians)
+	 *  as seen from receiver station. Geometry vectors are NaN where no ephemeris
+	 *  was available for the satellite.
+	 */
+        std::vector<double> S_elev;
+	
+	//! Stores satellite azimuth for @ref S.
+        /*! This vector stores for each element in @ref S , satellite azimuth (radians).
+	 */
+        std::vector<double> S_azim;
+	
+	//! Stores IPP latitude for @ref S.
+        /*! This vector stores for each element in @ref S , IPP latitude (degrees).
+	 */
+        std::vector<double> S_ippLat;
+	
+	//! Stores IPP longitude for @ref S.
+        /*! This vector stores for each element in @ref S , IPP longitude (degrees).
+	 */
+        std::vector<double> S_ippLon;
+	
+	//! Stores slant obliquity factor for @ref S.
+        /*! This vector stores for each element in @ref S , the obliquity factor 
+	 *  mapping vertical TEC to slant TEC at IPP.
+	 */
+        std::vector<double> S_obliq;
+	
+	//! Stores vTECeq polynomial x coordinate for @ref S.
+        /*! This vector stores for each element in @ref S , IPP longitude difference from
+	 *  receiver station plus Earth rotation since sampling block mid time (radians).
+	 */
+        std::vector<double> S_x;
+	
+	//! Stores vTECeq polynomial y coordinate for @ref S.
+        /*! This vector stores for each element in @ref S , MODIP of IPP minus MODIP of 
+	 *  receiver station (radians), from @ref igrf grids.
+	 */
+        std::vector<double> S_y;
+        
+	
 	//!Builds vector S.
         /*!This function builds and stores vector S given interval duration in minutes for which
 	 * vTECeq Coefficients are freezed.
@@ -170,6 +214,15 @@ class solver
 	 */
         void cleanUp();
 	
+	//!Rebuilds system over a range of epochs.
+        /*!This function drops previously built system and builds @ref S, B and A again
+	 * only from values of epochs [first, last), used for partial solutions while 
+	 * observation data is streamed. Range should span whole sampling blocks.
+	 * @param first First epoch index.
+	 * @param last Epoch index after last epoch.
+	 */
+        void solveEpochs(int first, int last);
+	
 	
 	//!Maximum sampling block size for vector S.
 	int SdimbMax;
@@ -0,0 +1,217 @@
+/*
+    GTEC -  A high performance standardized implementation of 
+    Multi Constellation GNSS Derived TEC Calibration 
+    (Model by T/ICT4D Lab ICTP).
+    Copyright (C) 2016,2017  Muhammad Owais
+    
+    This file is part of GTEC.
+
+    GTEC is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    GTEC is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with GTEC.  If not, see <http://www.gnu.org/licenses/>.
+    
+    Disclaimer: GTEC is a research implementation which is under 
+    development and should not be considered fully functional unless 
+    otherwise stated or a release is announced. Author is providing this 
+    software on a best effort AS IS basis and do not warrant validity, 
+    functionality, and suitability for any particular purpose. All copyright 
+    notices must be kept intact. 
+
+*/
+
+#include "ObsData.hpp"
+#include "constants.hpp"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+
+
+int main(int argc, char* argv[])
+{
+    int failures = 0;
+    double C1, L1, C2, L2;
+    int lli;
+
+    //Blank LLI and odd signal strength of L1, signal strength is not taken as LLI
+    std::string line = "G05  23619095.450 7 124120412.618 7        45.000    23619098.650 7  96717235.466 7        41.000  ";
+    if(!ObsData::readObservables(line, C1, L1, C2, L2, lli) || lli != 0 ||
+       std::fabs(C1 - 23619095.450) > 1e-6 || std::fabs(L1 - 124120412.618) > 1e-6 ||
+       std::fabs(C2 - 23619098.650) > 1e-6 || std::fabs(L2 - 96717235.466) > 1e-6)
+    {
+        std::cout << "***FAIL*** blank LLI " << lli << " " << L1 << "\n";
+        failures += 1;
+    }
+
+    //LLI and signal strength both set, digits glued to value
+    line = "G05  23619095.45017 124120412.61817        45.000    23619098.65017  96717235.46615        41.000  ";
+    if(!ObsData::readObservables(line, C1, L1, C2, L2, lli) || lli != 1 ||
+       std::fabs(C1 - 23619095.450) > 1e-6 || std::fabs(L1 - 124120412.618) > 1e-6 ||
+       std::fabs(L2 - 96717235.466) > 1e-6)
+    {
+        std::cout << "***FAIL*** LLI and signal strength " << lli << " " << L1 << "\n";
+        failures += 1;
+    }
+
+    //Invalid field is reported
+    line = "G05  23619095.450 7 124120412.61x 7        45.000    23619098.650 7  96717235.466 7        41.000  ";
+    if(ObsData::readObservables(line, C1, L1, C2, L2, lli))
+    {
+        std::cout << "***FAIL*** invalid field accepted\n";
+        failures += 1;
+    }
+
+    //Satellite with blank L2 has no usable TEC at that epoch
+    char dirTemplate[] = "/tmp/test_ObsDataXXXXXX";
+    std::string dir = mkdtemp(dirTemplate);
+    std::string fname = dir + "/test0020.16o";
+    std::ofstream out(fname.c_str());
+    out << "     3.02           OBSERVATION DATA    M                   RINEX VERSION / TYPE\n"
+        << "  4000000.0000  3000000.0000  3500000.0000                  APPROX POSITION XYZ\n"
+        << "G    6 C1C L1C S1C C2W L2W S2W                              SYS / # / OBS TYPES\n"
+        << "    30.000                                                  INTERVAL\n"
+        << "  2016     1     2     0     0    0.0000000     GPS         TIME OF FIRST OBS\n"
+        << "                                                            END OF HEADER\n";
+    for(int k = 0; k < 3; ++k)
+    {
+        char text[160];
+        sprintf(text, "> 2016 01 02 00 %02d 00.0000000  0  2\n", k);
+        out << text;
+        for(int prn = 1; prn <= 2; ++prn)
+        {
+            sprintf(text, "G%02d%14.3f  %14.3f  %14.3f  %14.3f  %14.3f  %14.3f  \n",
+                    prn, 23619095.450, 124120412.618, 45.0, 23619098.650, 96717235.466, 41.0);
+            //blank L2 field (columns 67-80)
+            if(prn == 2 && k == 1)
+                std::string(14, ' ').copy(text + 67, 14);
+            out << text;
+        }
+    }
+    out.close();
+
+    ObsData obs(std::vector<std::string>(1, fname), "G");
+    obs.read();
+    if(obs.validEpochs[1].size() != 3 || !obs.validEpochs[1].test(0) || obs.validEpochs[1].test(1) ||
+       !obs.validEpochs[1].test(2) || !obs.validEpochs[0].test(1))
+    {
+        std::cout << "***FAIL*** blank L2 marked valid\n";
+        failures += 1;
+    }
+    remove(fname.c_str());
+
+    //Hatch filter on synthetic G01 arc: code TEC has a constant bias and noise, phase TEC
+    //follows ionosphere with an ambiguity offset, arc is cut by a gap of epochs [200, 210)
+    const double f1 = 1575.42e6, f2 = 1227.60e6;
+    const double K = 40.3 * TECU;
+    const double tau = 1.0 / (40.3 * ((1.0 / (f2 * f2)) - (1.0 / (f1 * f1))));
+    const int numEpochs = 400;
+    std::vector<double> codeTEC(numEpochs), trueTEC(numEpochs);
+    unsigned int seed = 12345;
+    fname = dir + "/hatc0020.16o";
+    out.open(fname.c_str());
+    out << "     3.02           OBSERVATION DATA    M                   RINEX VERSION / TYPE\n"
+        << "  4000000.0000  3000000.0000  3500000.0000                  APPROX POSITION XYZ\n"
+        << "G    6 C1C L1C S1C C2W L2W S2W                              SYS / # / OBS TYPES\n"
+        << "    30.000                                                  INTERVAL\n"
+        << "  2016     1     2     0     0    0.0000000     GPS         TIME OF FIRST OBS\n"
+        << "                                                            END OF HEADER\n";
+    for(int k = 0; k < numEpochs; ++k)
+    {
+        double rho = 2.2e7 + 50.0 * k;
+        double I1 = K * (20.0 + 0.02 * k) / (f1 * f1);
+        double I2 = K * (20.0 + 0.02 * k) / (f2 * f2);
+        double noise[2];
+        for(int j = 0; j < 2; ++j)
+        {
+            seed = seed * 1103515245u + 12345u;
+            noise[j] = 0.6 * ((seed >> 8) / 16777216.0 - 0.5);
+        }
+        double C1 = rho + I1 + noise[0];
+        double C2 = rho + I2 + 3.0 + noise[1];
+        codeTEC[k] = tau * (C2 - C1) / TECU;
+        trueTEC[k] = tau * (I2 - I1 + 3.0) / TECU;
+        //G02 keeps epochs of the gap in the file
+        char text[160];
+        sprintf(text, "> 2016 01 02 %02d %02d %02d.0000000  0  1\n", k / 120, (k / 2) % 60, (k % 2) * 30);
+        out << text;
+        sprintf(text, "G%02d%14.3f", (k >= 200 && k < 210) ? 2 : 1, C1);
+        out << text;
+        sprintf(text, "  %14.3f  %14.3f  %14.3f  %14.3f  %14.3f  \n",
+                (rho - I1) * f1 / c + 1000.0, 45.0, C2, (rho - I2) * f2 / c + 2000.0, 41.0);
+        out << text;
+    }
+    out.close();
+
+    ObsData hatch(std::vector<std::string>(1, fname), "G");
+    hatch.read();
+    hatch.setHatchFilter(3600);
+    hatch.pre_process(10, 60, 6, 0.0f, 90.0f);
+    const std::vector<float>& smoothed = hatch.codeTEC[0];
+    double rawSq = 0.0, errSq = 0.0;
+    int count = 0;
+    for(int k = 150; k < numEpochs; ++k)
+    {
+        if(k >= 200 && k < 350)
+            continue;
+        rawSq += (codeTEC[k] - trueTEC[k]) * (codeTEC[k] - trueTEC[k]);
+        errSq += (smoothed[k] - trueTEC[k]) * (smoothed[k] - trueTEC[k]);
+        count += 1;
+    }
+    if(smoothed.size() != std::size_t(numEpochs) || std::sqrt(rawSq / count) < 1.5 || std::sqrt(errSq / count) > 0.5 ||
+       std::fabs(smoothed[210] - codeTEC[210]) > 1e-3 || !std::isnan(smoothed[205]))
+    {
+        std::cout << "***FAIL*** Hatch filter, code RMS " << std::sqrt(rawSq / count) << " smoothed RMS "
+                  << std::sqrt(errSq / count) << " restart " << smoothed[210] << " " << codeTEC[210] << "\n";
+        failures += 1;
+    }
+
+    //Elevation mask cuts epochs below 10 and above 80 degrees, NaN elevations are kept,
+    //same G01 arc with its gap
+    ObsData masked(std::vector<std::string>(1, fname), "G");
+    masked.read();
+    masked.satElevation.assign(120, std::vector<float>());
+    masked.satElevation[0].assign(numEpochs, 30.0f);
+    for(int k = 0; k < 50; ++k)
+        masked.satElevation[0][k] = 5.0f;
+    for(int k = 300; k < 320; ++k)
+        masked.satElevation[0][k] = 85.0f;
+    masked.satElevation[0][100] = std::numeric_limits<float>::quiet_NaN();
+    masked.pre_process(10, 60, 6, 10.0f, 80.0f);
+    const epochMask& kept = masked.validEpochs[0];
+    bool cut = true;
+    for(int k = 0; k < numEpochs; ++k)
+    {
+        bool inMask = (k >= 50 && k < 200) || (k >= 210 && k < 300) || k >= 320;
+        if(inMask != kept.test(k) || (!inMask && masked.GPS_ucTEC[0][k] != 0.0f))
+        {
+            cut = false;
+        }
+    }
+    if(!cut)
+    {
+        std::cout << "***FAIL*** elevation mask\n";
+        failures += 1;
+    }
+    remove(fname.c_str());
+    remove(dir.c_str());
+
+    if(failures != 0)
+    {
+        return 2;
+    }
+
+    std::cout << "***PASS***\n";
+    return 0;
+}
@@ -0,0 +1,97 @@
+/*
+    GTEC -  A high performance standardized implementation of 
+    Multi Constellation GNSS Derived TEC Calibration 
+    (Model by T/ICT4D Lab ICTP).
+    Copyright (C) 2016,2017  Muhammad Owais
+    
+    This file is part of GTEC.
+
+    GTEC is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    GTEC is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with GTEC.  If not, see <http://www.gnu.org/licenses/>.
+    
+    Disclaimer: GTEC is a research implementation which is under 
+    development and should not be considered fully functional unless 
+    otherwise stated or a release is announced. Author is providing this 
+    software on a best effort AS IS basis and do not warrant validity, 
+    functionality, and suitability for any particular purpose. All copyright 
+    notices must be kept intact. 
+
+*/
+
+#include "navigation.hpp"
+#include "constants.hpp"
+#include "triple.hpp"
+#include <iostream>
+#include <cmath>
+
+
+//Forward conversion of ellipsoidal (degrees, meters) to ECEF coordinates
+static triple toECEF(double lat, double lon, double h)
+{
+    double e2 = 1.0 - (b_WGS84 * b_WGS84) / (a_WGS84 * a_WGS84);
+    double phi = lat * M_PI / 180.0;
+    double lambda = lon * M_PI / 180.0;
+    double N = a_WGS84 / sqrt(1.0 - e2 * sin(phi) * sin(phi));
+    return triple((N + h) * cos(phi) * cos(lambda), (N + h) * cos(phi) * sin(lambda),
+                  (N * (1.0 - e2) + h) * sin(phi));
+}
+
+
+int main(int argc, char* argv[])
+{
+    int failures = 0;
+
+    //Points at equator, 45 degrees and poles, at Earth surface, ionosphere and GNSS orbit heights
+    const int numPoints = 8;
+    const double lat[numPoints] = { 0.0, 0.0, 45.0, 45.0, -45.0, 90.0, -90.0, 0.0 };
+    const double lon[numPoints] = { 0.0, 90.0, 45.0, 200.0, 315.0, 0.0, 0.0, 270.0 };
+    const double heights[3] = { 0.0, 350000.0, 20200000.0 };
+
+    for(int j = 0; j < 3; ++j)
+    {
+        double X[numPoints], Y[numPoints], Z[numPoints];
+        double bLat[numPoints], bLon[numPoints], bH[numPoints];
+        for(int k = 0; k < numPoints; ++k)
+        {
+            triple ecef = toECEF(lat[k], lon[k], heights[j]);
+            X[k] = ecef.X;
+            Y[k] = ecef.Y;
+            Z[k] = ecef.Z;
+        }
+        navigation::ecefToEllipsoidal(X, Y, Z, bLat, bLon, bH, numPoints);
+
+        for(int k = 0; k < numPoints; ++k)
+        {
+            triple ellipsoid;
+            navigation::ecefToEllipsoidal(triple(X[k], Y[k], Z[k]), ellipsoid);
+
+            //longitude is not defined at poles
+            bool pole = std::fabs(lat[k]) == 90.0;
+            if(std::fabs(bLat[k] - lat[k]) > 1e-9 || std::fabs(bH[k] - heights[j]) > 1e-4 ||
+               (!pole && std::fabs(bLon[k] - lon[k]) > 1e-9) ||
+               ellipsoid.X != bLat[k] || ellipsoid.Y != bLon[k] || ellipsoid.Z != bH[k])
+            {
+                std::cout << "***FAIL*** point " << lat[k] << " " << lon[k] << " " << heights[j] << ": "
+                          << bLat[k] << " " << bLon[k] << " " << bH[k] << "\n";
+                failures += 1;
+            }
+        }
+    }
+
+    if(failures != 0)
+    {
+        return 2;
+    }
+
+    std::cout << "***PASS***\n";
+    return 0;
+}
@@ -0,0 +1,167 @@
+/*
+    GTEC -  A high performance standardized implementation of 
+    Multi Constellation GNSS Derived TEC Calibration 
+    (Model by T/ICT4D Lab ICTP).
+    Copyright (C) 2016,2017  Muhammad Owais
+    
+    This file is part of GTEC.
+
+    GTEC is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    GTEC is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with GTEC.  If not, see <http://www.gnu.org/licenses/>.
+    
+    Disclaimer: GTEC is a research implementation which is under 
+    development and should not be considered fully functional unless 
+    otherwise stated or a release is announced. Author is providing this 
+    software on a best effort AS IS basis and do not warrant validity, 
+    functionality, and suitability for any particular purpose. All copyright 
+    notices must be kept intact. 
+
+*/
+
+#include "navigation.hpp"
+#include "ephemerisStore.hpp"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+
+//Writes a GPS record of prn at hour hh of 02/02/2016
+static void writeRecordG(std::ofstream& out, int prn, int hh)
+{
+    char epoch[32];
+    sprintf(epoch, "G%02d 2016 02 02 %02d 00 00", prn, hh);
+    out << epoch << " 1.230000000000D-04-2.842170943040D-12 0.000000000000D+00\n"
+        << "     5.500000000000D+01-1.234375000000D+01 4.490901922600D-09-2.946543288210D+00\n"
+        << "    -6.817281246190D-07 5.110442265870D-03 8.447840809820D-06 5.153702367780D+03\n"
+        << "     5.184000000000D+05-1.117587089540D-08 1.786235340380D+00-3.911554813390D-08\n"
+        << "     9.710011393880D-01 2.095625000000D+02 2.468416432000D-01-8.023905631470D-09\n"
+        << "    -1.625067692770D-10 1.000000000000D+00 1.878000000000D+03 0.000000000000D+00\n"
+        << "     2.000000000000D+00 0.000000000000D+00 5.122274160390D-09 5.500000000000D+01\n"
+        << "     5.112180000000D+05 4.000000000000D+00\n";
+}
+
+//Writes a navigation file with GPS records of prn for hours [h0, h1], and one GLONASS record
+static void writeNavFile(const std::string& fname, int prn, int h0, int h1)
+{
+    std::ofstream out(fname.c_str());
+    out << "     3.03           N: GNSS NAV DATA    M: MIXED            RINEX VERSION / TYPE\n"
+        << "    17                                                      LEAP SECONDS        \n"
+        << "                                                            END OF HEADER       \n";
+    for(int hh = h0; hh <= h1; ++hh)
+        writeRecordG(out, prn, hh);
+    out << "R01 2016 02 02 00 15 00 1.234000000000E-05 0.000000000000E+00 5.100000000000E+05\n"
+        << "     1.156700000000D+04-1.000000000000D+00 0.000000000000D+00 0.000000000000D+00\n"
+        << "     2.100000000000D+04 1.000000000000D+00 0.000000000000D+00 1.000000000000D+00\n"
+        << "    -1.000000000000D+03 3.000000000000D+00 1.000000000000D-09 0.000000000000D+00\n";
+}
+
+
+int main(int argc, char* argv[])
+{
+    int failures = 0;
+    char dirTemplate[] = "/tmp/test_ephemerisStoreXXXXXX";
+    std::string dir = mkdtemp(dirTemplate);
+    std::string file1 = dir + "/brdm0330.16p";
+    std::string file2 = dir + "/hour0330.16p";
+
+    //Overlapping records (hour 2) are de-duplicated
+    writeNavFile(file1, 1, 0, 2);
+    writeNavFile(file2, 1, 2, 4);
+
+    //First run parses files and writes the daily store
+    navigation parsed(std::vector<std::string>(1, file1));
+    parsed.read();
+
+    ephemerisStore store(ephemerisStore::storeName(file1));
+    if(!store.open() || !store.hasSource(file1) || store.hasSource(file2))
+    {
+        std::cout << "***FAIL*** store not written\n";
+        failures += 1;
+    }
+
+    //Second run loads records from the store
+    navigation cached(std::vector<std::string>(1, file1));
+    cached.read();
+    if(cached.ephemeris_G[0].size() != 3 || cached.ephemeris_R[0].size() != 1 ||
+       cached.leapSeconds != 17 || cached.version != parsed.version ||
+       cached.ephemeris_G[0][2].Toc != parsed.ephemeris_G[0][2].Toc ||
+       cached.ephemeris_G[0][1].Ahalf != parsed.ephemeris_G[0][1].Ahalf)
+    {
+        std::cout << "***FAIL*** records loaded from store\n";
+        failures += 1;
+    }
+
+    //A new file for the same day is appended to the store
+    std::vector<std::string> both;
+    both.push_back(file1);
+    both.push_back(file2);
+    navigation appended(both);
+    appended.read();
+
+    ephemerisStore store2(ephemerisStore::storeName(file2));
+    if(!store2.open() || !store2.hasSource(file1) || !store2.hasSource(file2))
+    {
+        std::cout << "***FAIL*** store not appended\n";
+        failures += 1;
+    }
+
+    navigation merged(both);
+    merged.read();
+    int n = merged.ephemeris_G[0].size();
+    bool sorted = true;
+    for(int i = 1; i < n; ++i)
+        sorted = sorted && merged.ephemeris_G[0][i - 1].Toc < merged.ephemeris_G[0][i].Toc;
+    if(n != 5 || !sorted || merged.ephemeris_R[0].size() != 1)
+    {
+        std::cout << "***FAIL*** merged store, " << n << " GPS records\n";
+        failures += 1;
+    }
+
+    //A changed file rebuilds the store, records of its old version are dropped
+    writeNavFile(file2, 1, 3, 3);
+    navigation rebuilt(both);
+    rebuilt.read();
+    ephemerisStore store3(ephemerisStore::storeName(file2));
+    n = rebuilt.ephemeris_G[0].size();
+    if(n != 4 || rebuilt.ephemeris_G[0][n - 1].Toc != merged.ephemeris_G[0][3].Toc ||
+       !store3.open() || !store3.hasSource(file1) || !store3.hasSource(file2))
+    {
+        std::cout << "***FAIL*** store not rebuilt, " << n << " GPS records\n";
+        failures += 1;
+    }
+
+    navigation reloaded(both);
+    reloaded.read();
+    if(reloaded.ephemeris_G[0].size() != 4 || reloaded.ephemeris_R[0].size() != 1)
+    {
+        std::cout << "***FAIL*** rebuilt store, " << reloaded.ephemeris_G[0].size() << " GPS records\n";
+        failures += 1;
+    }
+
+    remove(ephemerisStore::storeName(file1).c_str());
+    remove((dir + "/navcache").c_str());
+    remove(file1.c_str());
+    remove(file2.c_str());
+    remove(dir.c_str());
+
+    if(failures != 0)
+    {
+        return 2;
+    }
+
+    std::cout << "***PASS***\n";
+    return 0;
+}
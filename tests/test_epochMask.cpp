@@ -0,0 +1,114 @@
+/*
+    GTEC -  A high performance standardized implementation of 
+    Multi Constellation GNSS Derived TEC Calibration 
+    (Model by T/ICT4D Lab ICTP).
+    Copyright (C) 2016,2017  Muhammad Owais
+    
+    This file is part of GTEC.
+
+    GTEC is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    GTEC is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with GTEC.  If not, see <http://www.gnu.org/licenses/>.
+    
+    Disclaimer: GTEC is a research implementation which is under 
+    development and should not be considered fully functional unless 
+    otherwise stated or a release is announced. Author is providing this 
+    software on a best effort AS IS basis and do not warrant validity, 
+    functionality, and suitability for any particular purpose. All copyright 
+    notices must be kept intact. 
+
+*/
+
+#include "epochMask.hpp"
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+
+
+int main(int argc, char* argv[])
+{
+    int failures = 0;
+
+    //Random runs and gaps, checked against plain scans of a bool vector,
+    //sizes around word boundaries included
+    srand(7);
+    for(int trial = 0; trial < 200 && failures == 0; ++trial)
+    {
+        int n = (trial < 6) ? 62 + trial : rand() % 400;
+        epochMask mask;
+        std::vector<bool> ref;
+        bool state = false;
+        for(int k = 0; k < n; ++k)
+        {
+            if(rand() % 10 == 0)
+                state = !state;
+            mask.push(state);
+            ref.push_back(state);
+        }
+        if(mask.size() != n)
+        {
+            std::cout << "***FAIL*** size " << mask.size() << "\n";
+            failures += 1;
+        }
+        for(int q = 0; q < 50 && failures == 0; ++q)
+        {
+            int from = rand() % (n + 70);
+            int to = from + rand() % (n + 70);
+            int set = to, clear = to, last = from, count = 0;
+            for(int k = from; k < to; ++k)
+            {
+                bool v = (k < n) && ref[k];
+                if(v && set == to)
+                    set = k;
+                if(!v && clear == to)
+                    clear = k;
+                if(v)
+                {
+                    last = k + 1;
+                    count += 1;
+                }
+            }
+            if(mask.nextSet(from, to) != set || mask.nextClear(from, to) != clear ||
+               mask.lastSet(from, to) != last || mask.count(from, to) != count)
+            {
+                std::cout << "***FAIL*** scan of [" << from << ", " << to << ") size " << n << "\n";
+                failures += 1;
+            }
+        }
+    }
+
+    //Single bit updates
+    epochMask mask;
+    for(int k = 0; k < 130; ++k)
+    {
+        mask.push(true);
+    }
+    mask.reset(64);
+    if(mask.test(64) || !mask.test(63) || mask.nextClear(0, 130) != 64 || mask.count(0, 130) != 129)
+    {
+        std::cout << "***FAIL*** reset\n";
+        failures += 1;
+    }
+    mask.set(64);
+    if(!mask.test(64) || mask.nextClear(0, 130) != 130 || mask.test(130))
+    {
+        std::cout << "***FAIL*** set\n";
+        failures += 1;
+    }
+
+    if(failures != 0)
+    {
+        return 2;
+    }
+
+    std::cout << "***PASS***\n";
+    return 0;
+}
@@ -0,0 +1,117 @@
+/*
+    GTEC -  A high performance standardized implementation of 
+    Multi Constellation GNSS Derived TEC Calibration 
+    (Model by T/ICT4D Lab ICTP).
+    Copyright (C) 2016,2017  Muhammad Owais
+    
+    This file is part of GTEC.
+
+    GTEC is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    GTEC is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with GTEC.  If not, see <http://www.gnu.org/licenses/>.
+    
+    Disclaimer: GTEC is a research implementation which is under 
+    development and should not be considered fully functional unless 
+    otherwise stated or a release is announced. Author is providing this 
+    software on a best effort AS IS basis and do not warrant validity, 
+    functionality, and suitability for any particular purpose. All copyright 
+    notices must be kept intact. 
+
+*/
+
+#include "fieldParser.hpp"
+#include <iostream>
+#include <string>
+#include <cmath>
+
+
+int main(int argc, char* argv[])
+{
+    int failures = 0;
+    double v[4];
+    int n;
+
+    //Broadcast orbit line with glued D19.12 fields (4X,4D19.12)
+    std::string line = "     1.234000000000D-05-2.100000000000D+00 5.153702367780E+03-8.023905631470d-09";
+    const char* p = line.data();
+    int len = line.size();
+
+    bool ok = fieldParser::toDouble(p, len, 4, 19, v[0]);
+    ok = fieldParser::toDouble(p, len, 23, 19, v[1]) && ok;
+    ok = fieldParser::toDouble(p, len, 42, 19, v[2]) && ok;
+    ok = fieldParser::toDouble(p, len, 61, 19, v[3]) && ok;
+
+    if(!ok || std::fabs(v[0] - 1.234e-05) > 1e-17 || v[1] != -2.1 ||
+       std::fabs(v[2] - 5153.70236778) > 1e-9 || std::fabs(v[3] + 8.02390563147e-09) > 1e-20)
+    {
+        std::cout << "***FAIL*** glued D19.12 fields\n";
+        std::cout << v[0] << " " << v[1] << " " << v[2] << " " << v[3] << "\n";
+        failures += 1;
+    }
+
+    //Trailing fields missing from a trimmed line are blank, i.e. zero
+    line = "     2.000000000000D+00";
+    ok = fieldParser::toDouble(line.data(), line.size(), 4, 19, v[0]);
+    ok = fieldParser::toDouble(line.data(), line.size(), 23, 19, v[1]) && ok;
+    ok = fieldParser::toDouble(line.data(), line.size(), 42, 19, v[2]) && ok;
+    if(!ok || v[0] != 2.0 || v[1] != 0.0 || v[2] != 0.0)
+    {
+        std::cout << "***FAIL*** trimmed line\n";
+        failures += 1;
+    }
+
+    //Invalid characters are reported
+    line = "     2.00000000000XD+00";
+    if(fieldParser::toDouble(line.data(), line.size(), 4, 19, v[0]))
+    {
+        std::cout << "***FAIL*** invalid field accepted\n";
+        failures += 1;
+    }
+
+    //Fields without a mantissa digit are not numbers
+    const char* noDigits[4] = { "    -", "    .", " D+05", "   +." };
+    for(int k = 0; k < 4; ++k)
+    {
+        if(fieldParser::toDouble(noDigits[k], 5, 0, 5, v[0]))
+        {
+            std::cout << "***FAIL*** field without digits accepted: '" << noDigits[k] << "'\n";
+            failures += 1;
+        }
+    }
+    if(fieldParser::toInt("   -", 4, 0, 4, n))
+    {
+        std::cout << "***FAIL*** integer sign without digits accepted\n";
+        failures += 1;
+    }
+
+    //Epoch line integers (A1,I2.2,1X,I4,5(1X,I2.2))
+    line = "G05 2016 01 02 00 00 00";
+    ok = fieldParser::toInt(line.data(), line.size(), 1, 2, n);
+    if(!ok || n != 5)
+    {
+        std::cout << "***FAIL*** integer field\n";
+        failures += 1;
+    }
+    ok = fieldParser::toInt(line.data(), line.size(), 4, 4, n);
+    if(!ok || n != 2016)
+    {
+        std::cout << "***FAIL*** integer field\n";
+        failures += 1;
+    }
+
+    if(failures != 0)
+    {
+        return 2;
+    }
+
+    std::cout << "***PASS***\n";
+    return 0;
+}
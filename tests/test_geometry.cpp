@@ -0,0 +1,117 @@
+/*
+    GTEC -  A high performance standardized implementation of 
+    Multi Constellation GNSS Derived TEC Calibration 
+    (Model by T/ICT4D Lab ICTP).
+    Copyright (C) 2016,2017  Muhammad Owais
+    
+    This file is part of GTEC.
+
+    GTEC is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    GTEC is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with GTEC.  If not, see <http://www.gnu.org/licenses/>.
+    
+    Disclaimer: GTEC is a research implementation which is under 
+    development and should not be considered fully functional unless 
+    otherwise stated or a release is announced. Author is providing this 
+    software on a best effort AS IS basis and do not warrant validity, 
+    functionality, and suitability for any particular purpose. All copyright 
+    notices must be kept intact. 
+
+*/
+
+#include "geometry.hpp"
+#include "navigation.hpp"
+#include "constants.hpp"
+#include "triple.hpp"
+#include <iostream>
+#include <cmath>
+
+
+//Satellite at range 20200 Km from station, at given elevation and azimuth (degrees)
+static triple satellite(const triple& marker, const triple& markerEllip, double el, double az)
+{
+    double phi = markerEllip.X * M_PI / 180.0;
+    double lambda = markerEllip.Y * M_PI / 180.0;
+    double e = cos(el * M_PI / 180.0) * sin(az * M_PI / 180.0);
+    double n = cos(el * M_PI / 180.0) * cos(az * M_PI / 180.0);
+    double u = sin(el * M_PI / 180.0);
+    double range = 20200000.0;
+    return triple(marker.X + range * (-sin(lambda) * e - cos(lambda) * sin(phi) * n + cos(lambda) * cos(phi) * u),
+                  marker.Y + range * (cos(lambda) * e - sin(lambda) * sin(phi) * n + sin(lambda) * cos(phi) * u),
+                  marker.Z + range * (cos(phi) * n + sin(phi) * u));
+}
+
+
+int main(int argc, char* argv[])
+{
+    int failures = 0;
+    navigation nav((std::vector<std::string>()));
+    double rh = 350.0;
+
+    //Stations at mid latitude, equator and high latitude (ECEF, meters)
+    triple markers[3] = { triple(4336900.0, 1071700.0, 4537300.0),
+                          triple(6378137.0, 0.0, 0.0),
+                          triple(-1100000.0, -1350000.0, 6150000.0) };
+    const double el[4] = { 85.0, 45.0, 20.0, 5.0 };
+    const double az[4] = { 10.0, 100.0, 200.0, 300.0 };
+
+    for(int m = 0; m < 3; ++m)
+    {
+        triple markerEllip;
+        navigation::ecefToEllipsoidal(markers[m], markerEllip);
+        geometry geo(markers[m], markerEllip, rh);
+
+        //legacy routine takes longitude, latitude in radians
+        triple legacyEllip(markerEllip.Y * M_PI / 180.0, markerEllip.X * M_PI / 180.0, markerEllip.Z);
+
+        for(int k = 0; k < 4; ++k)
+        {
+            triple sat = satellite(markers[m], markerEllip, el[k], az[k]);
+            double elevation, azimuth, obliquity;
+            triple ipp;
+            geo.compute(sat, elevation, azimuth, ipp, obliquity);
+
+            double legacyElevation, legacyAzimuth, zenith;
+            triple legacyIPP;
+            nav.satElevAzim(markers[m], sat, legacyEllip, legacyElevation, legacyAzimuth);
+            int status = nav.computeIPP(markers[m], sat, rh, legacyIPP, zenith);
+            double r = sqrt(legacyIPP.X * legacyIPP.X + legacyIPP.Y * legacyIPP.Y + legacyIPP.Z * legacyIPP.Z);
+            double legacyLat = asin(legacyIPP.Z / r) * 180.0 / M_PI;
+            double legacyLon = atan2(legacyIPP.Y, legacyIPP.X) * 180.0 / M_PI;
+            legacyLon += (legacyLon < 0.0) ? 360.0 : 0.0;
+
+            //legacy azimuth is atan of east / north, defined modulo pi
+            if(status != 0 || std::fabs(elevation - el[k] * M_PI / 180.0) > 1e-9 ||
+               std::fabs(elevation - legacyElevation) > 1e-9 ||
+               std::fabs(azimuth - az[k] * M_PI / 180.0) > 1e-9 ||
+               std::fabs(std::remainder(azimuth - legacyAzimuth, M_PI)) > 1e-9 ||
+               std::fabs(ipp.X - legacyLat) > 1e-7 || std::fabs(ipp.Y - legacyLon) > 1e-7 ||
+               std::fabs(r - Re_mean - rh * 1000.0) > 1e-3 ||
+               std::fabs(obliquity - 1.0 / cos(zenith)) > 1e-7)
+            {
+                std::cout << "***FAIL*** station " << m << " satellite " << k << "\n";
+                std::cout << "elevation " << elevation << " " << legacyElevation << " azimuth " << azimuth
+                          << " " << legacyAzimuth << "\n";
+                std::cout << "IPP " << ipp.X << " " << ipp.Y << " " << legacyLat << " " << legacyLon
+                          << " obliquity " << obliquity << " " << 1.0 / cos(zenith) << "\n";
+                failures += 1;
+            }
+        }
+    }
+
+    if(failures != 0)
+    {
+        return 2;
+    }
+
+    std::cout << "***PASS***\n";
+    return 0;
+}
@@ -0,0 +1,243 @@
+/*
+    GTEC -  A high performance standardized implementation of 
+    Multi Constellation GNSS Derived TEC Calibration 
+    (Model by T/ICT4D Lab ICTP).
+    Copyright (C) 2016,2017  Muhammad Owais
+    
+    This file is part of GTEC.
+
+    GTEC is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    GTEC is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with GTEC.  If not, see <http://www.gnu.org/licenses/>.
+    
+    Disclaimer: GTEC is a research implementation which is under 
+    development and should not be considered fully functional unless 
+    otherwise stated or a release is announced. Author is providing this 
+    software on a best effort AS IS basis and do not warrant validity, 
+    functionality, and suitability for any particular purpose. All copyright 
+    notices must be kept intact. 
+
+*/
+
+#define __STDCPP_WANT_MATH_SPEC_FUNCS__ 1
+#include "triple.hpp"
+#include "igrf.hpp"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cmath>
+#include <limits>
+#include <cstdio>
+#include <cstdlib>
+
+
+//IGRF-13 dipole coefficients (nT) g10, g11, h11 for 2015.0 (DGRF) and 2020.0 (IGRF),
+//and secular variation for 2020-25 (nT/year)
+static const double dipole2015[3] = { -29441.46, -1501.77, 4795.99 };
+static const double dipole2020[3] = { -29404.8, -1450.9, 4652.5 };
+static const double dipoleSV[3] = { 5.7, 7.4, -25.9 };
+
+static const double deg = M_PI / 180.0;
+
+
+//Closed form dipole field at Earth surface, geocentric latitude and longitude in radians
+static void dipoleField(const double* c, double lat, double lon, double& F, double& D, double& I)
+{
+    double theta = M_PI / 2.0 - lat;
+    double e = c[1] * cos(lon) + c[2] * sin(lon);
+    double X = -c[0] * sin(theta) + e * cos(theta);
+    double Y = c[1] * sin(lon) - c[2] * cos(lon);
+    double Z = -2.0 * (c[0] * cos(theta) + e * sin(theta));
+    double H = sqrt(X * X + Y * Y);
+    F = sqrt(H * H + Z * Z);
+    D = atan2(Y, X);
+    I = atan2(Z, H);
+}
+
+
+//Compares computed field with closed form dipole of coefficients c
+static int checkField(igrf& model, const double* c, double lat, double lon, double t, const char* name)
+{
+    double H, F, D, I;
+    double refF, refD, refI;
+    model.computeField(6371200.0, lat, lon, t, H, F, D, I);
+    dipoleField(c, lat, lon, refF, refD, refI);
+    if(fabs(F - refF) > 1e-6 || fabs(D - refD) > 1e-9 || fabs(I - refI) > 1e-9)
+    {
+        std::cout << "***FAIL*** " << name << "\n";
+        std::cout << "F: " << F << " " << refF << " D: " << D / deg << " " << refD / deg
+                  << " I: " << I / deg << " " << refI / deg << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+
+//Potential over a (nT) of a degree 13 model at geocentric radius rho (in units of a),
+//colatitude theta and longitude phi, with Schmidt semi-normalised std::assoc_legendre
+static double potential(const double g[14][14], const double h[14][14], double rho, double theta, double phi)
+{
+    double W = 0.0;
+    for(int n = 1; n <= 13; ++n)
+        for(int m = 0; m <= n; ++m)
+        {
+            double schmidt = 1.0;
+            if(m > 0)
+                schmidt = std::sqrt(2.0 * std::tgamma(n - m + 1.0) / std::tgamma(n + m + 1.0));
+            double P = schmidt * std::assoc_legendre(n, m, cos(theta));
+            W += std::pow(1.0 / rho, n + 1) * P * (g[n][m] * cos(m * phi) + h[n][m] * sin(m * phi));
+        }
+    return W;
+}
+
+
+//Writes a text inclination grid, 3 x 3 points around (0, 1) degrees, of constant inclination
+static void writeGrid(const std::string& fname, double incl)
+{
+    std::ofstream out(fname.c_str());
+    out << "inclination grid\nlatitude longitude height inclination\n\n";
+    for(int i = -1; i <= 1; ++i)
+        for(int j = 0; j <= 2; ++j)
+            out << i << " " << j << " 350 " << incl << "\n";
+}
+
+
+int main(int argc, char* argv[])
+{
+    int failures = 0;
+    char dirTemplate[] = "/tmp/test_igrfXXXXXX";
+    std::string dir = mkdtemp(dirTemplate);
+    std::string coeffName = dir + "/dipole.txt";
+
+    std::ofstream coeffFile(coeffName.c_str());
+    coeffFile.precision(10);
+    coeffFile << "g/h n m 2015.0 2020.0 2020-25\n"
+              << "g 1 0 " << dipole2015[0] << " " << dipole2020[0] << " " << dipoleSV[0] << "\n"
+              << "g 1 1 " << dipole2015[1] << " " << dipole2020[1] << " " << dipoleSV[1] << "\n"
+              << "h 1 1 " << dipole2015[2] << " " << dipole2020[2] << " " << dipoleSV[2] << "\n";
+    coeffFile.close();
+    igrf model(coeffName);
+
+    //Published IGRF-13 geomagnetic north pole 2020.0: 80.65 N, 72.68 W (geodetic),
+    //field is vertical and F is twice the dipole field strength
+    double e2 = 0.00669437999014;
+    double poleLat = atan((1.0 - e2) * tan(80.65 * deg));
+    double H, F, D, I;
+    model.computeField(6371200.0, poleLat, -72.68 * deg, 2020.0, H, F, D, I);
+    double B0 = sqrt(dipole2020[0] * dipole2020[0] + dipole2020[1] * dipole2020[1] + dipole2020[2] * dipole2020[2]);
+    if(I < 89.98 * deg || fabs(F - 2.0 * B0) > 0.5)
+    {
+        std::cout << "***FAIL*** geomagnetic pole 2020, I: " << I / deg << " F: " << F << "\n";
+        failures += 1;
+    }
+
+    //Trieste (45.633 N, 13.767 E) at model epoch, between epochs, after last and before first epoch
+    double lat = 45.633 * deg;
+    double lon = 13.767 * deg;
+    double c[3];
+    failures += checkField(model, dipole2020, lat, lon, 2020.0, "model epoch");
+    for(int k = 0; k < 3; ++k)
+        c[k] = dipole2015[k] + 0.4 * (dipole2020[k] - dipole2015[k]);
+    failures += checkField(model, c, lat, lon, 2017.0, "interpolation");
+    for(int k = 0; k < 3; ++k)
+        c[k] = dipole2020[k] + 3.0 * dipoleSV[k];
+    failures += checkField(model, c, lat, lon, 2023.0, "secular variation");
+    for(int k = 0; k < 3; ++k)
+        c[k] = dipole2015[k] - (dipole2020[k] - dipole2015[k]);
+    failures += checkField(model, c, lat, lon, 2010.0, "before first epoch");
+
+    //Degree 13 model, field compared with finite differences of potential
+    double gn[14][14] = {};
+    double hn[14][14] = {};
+    std::string fullName = dir + "/degree13.txt";
+    std::ofstream fullFile(fullName.c_str());
+    fullFile.precision(17);
+    fullFile << "g/h n m 2020.0\n";
+    for(int n = 1; n <= 13; ++n)
+        for(int m = 0; m <= n; ++m)
+        {
+            gn[n][m] = 30000.0 / (n * n * n) * cos(7.0 * n + 3.0 * m);
+            fullFile << "g " << n << " " << m << " " << gn[n][m] << "\n";
+            if(m > 0)
+            {
+                hn[n][m] = 30000.0 / (n * n * n) * sin(7.0 * n + 3.0 * m);
+                fullFile << "h " << n << " " << m << " " << hn[n][m] << "\n";
+            }
+        }
+    fullFile.close();
+    {
+        igrf full(fullName);
+        const double points[3][2] = { { 45.633, 13.767 }, { -70.0, 250.0 }, { 5.0, 120.0 } };
+        double rho = (6371200.0 + 350000.0) / 6371200.0;
+        double step = 1e-4;
+        for(int k = 0; k < 3; ++k)
+        {
+            double theta = M_PI / 2.0 - points[k][0] * deg;
+            double phi = points[k][1] * deg;
+            double X = (potential(gn, hn, rho, theta + step, phi) - potential(gn, hn, rho, theta - step, phi)) / (2.0 * step) / rho;
+            double Y = -(potential(gn, hn, rho, theta, phi + step) - potential(gn, hn, rho, theta, phi - step)) / (2.0 * step) / (rho * sin(theta));
+            double Z = (potential(gn, hn, rho + step, theta, phi) - potential(gn, hn, rho - step, theta, phi)) / (2.0 * step);
+            full.computeField(rho * 6371200.0, points[k][0] * deg, phi, 2020.0, H, F, D, I);
+            if(fabs(H * cos(D) - X) > 1e-3 || fabs(H * sin(D) - Y) > 1e-3 || fabs(F * sin(I) - Z) > 1e-3)
+            {
+                std::cout << "***FAIL*** degree 13 field at " << points[k][0] << " " << points[k][1] << "\n";
+                std::cout << "X: " << H * cos(D) << " " << X << " Y: " << H * sin(D) << " " << Y
+                          << " Z: " << F * sin(I) << " " << Z << "\n";
+                failures += 1;
+            }
+        }
+    }
+    remove(fullName.c_str());
+
+    //Without coefficient file, inclinations after 2019 are extrapolated from 2010 and 2015 grids
+    writeGrid(dir + "/igrf_2010_IPP.txt", 10.0);
+    writeGrid(dir + "/igrf_2010_station.txt", 10.0);
+    writeGrid(dir + "/igrf_2015_IPP.txt", 12.0);
+    writeGrid(dir + "/igrf_2015_station.txt", 12.0);
+    {
+        igrf grid(2022.5, dir, 350);
+        triple pos(0.5, 1.5, 0.0);
+        double expected = atan(15.0 * deg / sqrt(cos(0.5 * deg)));
+        if(fabs(grid.getMODIP(pos) - expected) > 1e-6 || fabs(grid.getStationMODIP(pos) - expected) > 1e-6)
+        {
+            std::cout << "***FAIL*** grid extrapolation, MODIP: " << grid.getMODIP(pos) << " " << expected << "\n";
+            failures += 1;
+        }
+
+        //Points without coordinates have no MODIP
+        double lats[2] = { 0.5, std::numeric_limits<double>::quiet_NaN() };
+        double lons[2] = { std::numeric_limits<double>::quiet_NaN(), 1.5 };
+        double modip[2];
+        grid.getMODIP(lats, lons, modip, 2);
+        if(!std::isnan(modip[0]) || !std::isnan(modip[1]))
+        {
+            std::cout << "***FAIL*** MODIP of NaN coordinates: " << modip[0] << " " << modip[1] << "\n";
+            failures += 1;
+        }
+    }
+
+    const char* grids[4] = { "igrf_2010_IPP", "igrf_2010_station", "igrf_2015_IPP", "igrf_2015_station" };
+    for(int k = 0; k < 4; ++k)
+    {
+        remove((dir + "/" + grids[k] + ".txt").c_str());
+        remove((dir + "/" + grids[k] + ".bin").c_str());
+    }
+    remove(coeffName.c_str());
+    remove(dir.c_str());
+
+    if(failures != 0)
+    {
+        return 2;
+    }
+
+    std::cout << "***PASS***\n";
+    return 0;
+}
@@ -0,0 +1,158 @@
+/*
+    GTEC -  A high performance standardized implementation of 
+    Multi Constellation GNSS Derived TEC Calibration 
+    (Model by T/ICT4D Lab ICTP).
+    Copyright (C) 2016,2017  Muhammad Owais
+    
+    This file is part of GTEC.
+
+    GTEC is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    GTEC is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with GTEC.  If not, see <http://www.gnu.org/licenses/>.
+    
+    Disclaimer: GTEC is a research implementation which is under 
+    development and should not be considered fully functional unless 
+    otherwise stated or a release is announced. Author is providing this 
+    software on a best effort AS IS basis and do not warrant validity, 
+    functionality, and suitability for any particular purpose. All copyright 
+    notices must be kept intact. 
+
+*/
+
+#include "internalTime.hpp"
+#include <iostream>
+#include <string>
+#include <ctime>
+
+
+int main(int argc, char* argv[])
+{
+    int failures = 0;
+
+    //Days from civil against timegm, every 13 days from 1900 to 2200 (January and leap days included)
+    struct tm t = {};
+    for(long long d = -25567; d < 84000; d += 13)
+    {
+        time_t sec = d * 86400;
+        gmtime_r(&sec, &t);
+        internalTime it(t.tm_year + 1900, t.tm_mon + 1, t.tm_mday, 23, 59, 59);
+        it.toUNIXTime();
+        if(it.UNIX != sec + 86399)
+        {
+            std::cout << "***FAIL*** " << it.year << "/" << it.month << "/" << it.day << " " << it.UNIX << "\n";
+            failures += 1;
+            break;
+        }
+    }
+
+    //Century rule: 2000 is leap, 2100 is not
+    if(internalTime::daysFromCivil(2000, 3, 1) - internalTime::daysFromCivil(2000, 2, 28) != 2 ||
+       internalTime::daysFromCivil(2100, 3, 1) - internalTime::daysFromCivil(2100, 2, 28) != 1)
+    {
+        std::cout << "***FAIL*** leap years\n";
+        failures += 1;
+    }
+
+    //Beyond 2038
+    internalTime late(2040, 1, 1, 0, 0, 0);
+    late.toUNIXTime();
+    if(late.UNIX != 2208988800LL)
+    {
+        std::cout << "***FAIL*** 64-bit time " << late.UNIX << "\n";
+        failures += 1;
+    }
+
+    //RINEX 3 epoch record
+    std::string line = "> 2016 01 02 13 45 30.0000000  0 32";
+    internalTime epoch;
+    if(!epoch.parseEpoch(line.data(), line.size()) || epoch.year != 2016 || epoch.month != 1 ||
+       epoch.day != 2 || epoch.hour != 13 || epoch.minute != 45 || epoch.second != 30)
+    {
+        std::cout << "***FAIL*** epoch record\n";
+        failures += 1;
+    }
+    epoch.toUNIXTime();
+    if(epoch.UNIX != 1451742330LL)
+    {
+        std::cout << "***FAIL*** epoch record time " << epoch.UNIX << "\n";
+        failures += 1;
+    }
+
+    //50 Hz epoch keeps fraction of second exactly
+    line = "> 2016 01 02 13 45 30.0200000  0 32";
+    if(!epoch.parseEpoch(line.data(), line.size()) || epoch.second != 30 || epoch.nanosecond != 20000000)
+    {
+        std::cout << "***FAIL*** sub-second epoch record\n";
+        failures += 1;
+    }
+    epoch.toUNIXTime();
+    if(epoch.UNIXNano() != 1451742330020000000LL)
+    {
+        std::cout << "***FAIL*** sub-second epoch time " << epoch.UNIXNano() << "\n";
+        failures += 1;
+    }
+    epoch.parse("> 2016 1 2 13 45 59.99999999999");
+    if(epoch.minute != 45 || epoch.second != 60 || epoch.nanosecond != 0)
+    {
+        std::cout << "***FAIL*** separated fields rounding " << epoch.second << " " << epoch.nanosecond << "\n";
+        failures += 1;
+    }
+
+    //Malformed record is reported
+    line = "> 2016  1  2 13 45 30.0";
+    if(epoch.parseEpoch(line.data(), line.size()))
+    {
+        std::cout << "***FAIL*** malformed epoch record accepted\n";
+        failures += 1;
+    }
+
+    //Leap seconds: GPS - UTC was 17 s in 2016 and 18 s from 01/01/2017
+    long long leap2017 = internalTime::daysFromCivil(2017, 1, 1) * 86400;
+    if(internalTime::gpsUtcOffset(leap2017 - 1) != 17 || internalTime::gpsUtcOffset(leap2017) != 18 ||
+       internalTime::gpsUtcOffset(internalTime::daysFromCivil(1980, 1, 6) * 86400) != 0)
+    {
+        std::cout << "***FAIL*** leap second table\n";
+        failures += 1;
+    }
+    for(long long utc = leap2017 - 5; utc < leap2017 + 5; ++utc)
+    {
+        if(internalTime::gpstToUTC(internalTime::utcToGPST(utc)) != utc)
+        {
+            std::cout << "***FAIL*** GPST/UTC round trip at " << utc << "\n";
+            failures += 1;
+            break;
+        }
+    }
+
+    //Week and seconds of week: 02/01/2016 00:00:00 is GPS week 1877, BDT week 521, Saturday
+    int week, sow;
+    long long gpst = internalTime::daysFromCivil(2016, 1, 2) * 86400;
+    internalTime::toWeekSeconds(gpst, internalTime::GPS_EPOCH, week, sow);
+    if(week != 1877 || sow != 518400)
+    {
+        std::cout << "***FAIL*** GPS week " << week << " " << sow << "\n";
+        failures += 1;
+    }
+    internalTime::toWeekSeconds(internalTime::gpstToBDT(gpst), internalTime::BDT_EPOCH, week, sow);
+    if(week != 521 || sow != 518386)
+    {
+        std::cout << "***FAIL*** BDT week " << week << " " << sow << "\n";
+        failures += 1;
+    }
+
+    if(failures != 0)
+    {
+        return 2;
+    }
+
+    std::cout << "***PASS***\n";
+    return 0;
+}
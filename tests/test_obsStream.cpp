@@ -0,0 +1,185 @@
+/*
+    GTEC -  A high performance standardized implementation of 
+    Multi Constellation GNSS Derived TEC Calibration 
+    (Model by T/ICT4D Lab ICTP).
+    Copyright (C) 2016,2017  Muhammad Owais
+    
+    This file is part of GTEC.
+
+    GTEC is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    GTEC is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with GTEC.  If not, see <http://www.gnu.org/licenses/>.
+    
+    Disclaimer: GTEC is a research implementation which is under 
+    development and should not be considered fully functional unless 
+    otherwise stated or a release is announced. Author is providing this 
+    software on a best effort AS IS basis and do not warrant validity, 
+    functionality, and suitability for any particular purpose. All copyright 
+    notices must be kept intact. 
+
+*/
+
+#include "ObsData.hpp"
+#include "obsStream.hpp"
+#include "navigation.hpp"
+#include "constants.hpp"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/wait.h>
+
+
+//Builds a 1 hour, 30 s observation file of 02/01/2016 with G01 in view all the time,
+//with a 10 cycles slip of L1 at epoch 60, and G02 in view except epochs [40, 80), (20 minutes gap).
+static std::string observationText()
+{
+    std::string text =
+        "     3.02           OBSERVATION DATA    M                   RINEX VERSION / TYPE\n"
+        "  4000000.0000  3000000.0000  3500000.0000                  APPROX POSITION XYZ\n"
+        "G    6 C1C L1C S1C C2W L2W S2W                              SYS / # / OBS TYPES\n"
+        "    30.000                                                  INTERVAL\n"
+        "  2016     1     2     0     0    0.0000000     GPS         TIME OF FIRST OBS\n"
+        "                                                            END OF HEADER\n";
+    char line[160];
+    for(int k = 0; k < 120; ++k)
+    {
+        bool g2 = (k < 40 || k >= 80);
+        sprintf(line, "> 2016 01 02 %02d %02d %02d.0000000  0 %2d\n", k / 120, (k / 2) % 60, (k % 2) * 30, g2 ? 2 : 1);
+        text += line;
+        for(int prn = 1; prn <= (g2 ? 2 : 1); ++prn)
+        {
+            //range growing 100 m per epoch, constant ionospheric term on L2
+            double range = 20000000.0 + 100.0 * k + prn;
+            double L1 = range * GPS_f1 / c + ((prn == 1 && k >= 60) ? 10.0 : 0.0);
+            double L2 = range * GPS_f2 / c + 1000.0;
+            sprintf(line, "G%02d%14.3f  %14.3f  %14.3f  %14.3f  %14.3f  %14.3f  \n", prn, range, L1, 45.0, range, L2, 45.0);
+            text += line;
+        }
+    }
+    return text;
+}
+
+
+int main(int argc, char* argv[])
+{
+    int failures = 0;
+    char dirTemplate[] = "/tmp/test_obsStreamXXXXXX";
+    std::string dir = mkdtemp(dirTemplate);
+    std::string fname = dir + "/strm0020.16o";
+    std::string rotated = fname + ".1";
+    std::string text = observationText();
+
+    //Stream has to watch before writer starts
+    ObsData streamed(std::vector<std::string>(1, fname), "G");
+    obsStream stream(streamed, fname);
+    navigation nav((std::vector<std::string>()));
+
+    //Writer process appends in small chunks, cutting lines, opening and closing file for each chunk
+    //as loggers writing each epoch do, then rotates file
+    pid_t writer = fork();
+    if(writer == 0)
+    {
+        for(std::size_t i = 0; i < text.size(); i += 700)
+        {
+            std::ofstream out(fname.c_str(), std::ios::app);
+            out << text.substr(i, 700);
+            out.close();
+            usleep(2000);
+        }
+        rename(fname.c_str(), rotated.c_str());
+        _exit(0);
+    }
+
+    //Closed arcs are processed while streaming and once more when writer rotates file
+    int first, last;
+    int arcs = 0;
+    int polls = 0;
+    while(!stream.finished && polls < 10000)
+    {
+        stream.poll(1000);
+        polls += 1;
+        if(stream.headerRead)
+            arcs += streamed.processClosedArcs(nav, 350, 5, 300, 6, 0.0, 90.0, first, last);
+    }
+    waitpid(writer, NULL, 0);
+    if(!stream.finished)
+    {
+        std::cout << "***FAIL*** file rotation not seen\n";
+        failures += 1;
+    }
+    arcs += streamed.processClosedArcs(nav, 350, 5, 300, 6, 0.0, 90.0, first, last, true);
+
+    //Same file read at once
+    ObsData batch(std::vector<std::string>(1, rotated), "G");
+    batch.read();
+
+    if(streamed.timeline_main != batch.timeline_main || streamed.interval != batch.interval)
+    {
+        std::cout << "***FAIL*** timeline " << streamed.timeline_main.size() << " vs " << batch.timeline_main.size() << "\n";
+        failures += 1;
+    }
+    //raw observables are not changed by preprocessing
+    for(int prn = 0; prn < 2; ++prn)
+    {
+        bool same = (streamed.code1[prn] == batch.code1[prn] && streamed.wideLane[prn] == batch.wideLane[prn] &&
+                     streamed.GPS_ucTEC[prn].size() == batch.GPS_ucTEC[prn].size() && batch.code1[prn].size() == 120);
+        if(!same)
+        {
+            std::cout << "***FAIL*** G0" << prn + 1 << " series\n";
+            failures += 1;
+        }
+    }
+
+    //G01 [0, 59] and [61, 119] (slip epoch dropped), G02 [0, 39] and [80, 119], each once
+    bool arcsOk = (arcs == 4 && streamed.arcs.size() == 4);
+    for(int j = 0; arcsOk && j < streamed.arcs.size(); ++j)
+    {
+        int s = streamed.arcs.start[j];
+        int e = streamed.arcs.end[j] - 1;
+        int id = streamed.arcs.sat[j] + 1;
+        arcsOk = (id == 1 && s == 0 && e == 59) || (id == 1 && s == 61 && e == 119) || (id == 2 && s == 0 && e == 39) || (id == 2 && s == 80 && e == 119);
+    }
+    if(!arcsOk)
+    {
+        std::cout << "***FAIL*** closed arcs " << arcs << "\n";
+        failures += 1;
+    }
+
+    //File no longer growing ends stream after idle timeout, with all its epochs
+    ObsData idle(std::vector<std::string>(1, rotated), "G");
+    obsStream idleStream(idle, rotated, 1);
+    polls = 0;
+    while(!idleStream.finished && polls < 50)
+    {
+        idleStream.poll(100);
+        polls += 1;
+    }
+    if(!idleStream.finished || idle.timeline_main.size() != 120 || idle.code1[1].size() != 120)
+    {
+        std::cout << "***FAIL*** idle timeout " << idle.timeline_main.size() << "\n";
+        failures += 1;
+    }
+
+    unlink(rotated.c_str());
+    rmdir(dir.c_str());
+
+    if(failures != 0)
+    {
+        return 2;
+    }
+
+    std::cout << "***PASS***\n";
+    return 0;
+}
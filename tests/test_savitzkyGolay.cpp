@@ -0,0 +1,97 @@
+/*
+    GTEC -  A high performance standardized implementation of 
+    Multi Constellation GNSS Derived TEC Calibration 
+    (Model by T/ICT4D Lab ICTP).
+    Copyright (C) 2016,2017  Muhammad Owais
+    
+    This file is part of GTEC.
+
+    GTEC is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    GTEC is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with GTEC.  If not, see <http://www.gnu.org/licenses/>.
+    
+    Disclaimer: GTEC is a research implementation which is under 
+    development and should not be considered fully functional unless 
+    otherwise stated or a release is announced. Author is providing this 
+    software on a best effort AS IS basis and do not warrant validity, 
+    functionality, and suitability for any particular purpose. All copyright 
+    notices must be kept intact. 
+
+*/
+
+#include "savitzkyGolay.hpp"
+#include <iostream>
+#include <vector>
+#include <cmath>
+
+
+int main(int argc, char* argv[])
+{
+    int failures = 0;
+
+    //Default filter inside arc is mean of 3 previous and 3 next epochs, out-lier itself ignored
+    savitzkyGolay sg;
+    std::vector<float> v = { 1, 2, 3, 4, 5, 6, 100, 8, 9, 10, 11, 12, 13 };
+    const float* s = v.data();
+    const float* e = s + v.size();
+    float expected = (4 + 5 + 6 + 8 + 9 + 10) / 6.0f;
+    if(std::fabs(sg.estimate(s, e, s + 6) - expected) > 1e-4)
+    {
+        std::cout << "***FAIL*** centred mean " << sg.estimate(s, e, s + 6) << "\n";
+        failures += 1;
+    }
+
+    //Polynomials up to order are reproduced at every position, ends of arc included
+    for(int order = 0; order <= 4 && failures == 0; ++order)
+    {
+        for(int half = 1; half <= 8; ++half)
+        {
+            if(order >= 2 * half)
+                continue;
+            savitzkyGolay f(half, order);
+            std::vector<float> poly(40);
+            for(int k = 0; k < 40; ++k)
+            {
+                double x = (k - 20) / 10.0;
+                poly[k] = 3.0 + std::pow(x, order) - ((order > 0) ? 0.5 * x : 0.0);
+            }
+            for(int k = 0; k < 40; ++k)
+            {
+                float value = poly[k];
+                poly[k] = 1.0e6;
+                float est = f.estimate(poly.data(), poly.data() + 40, poly.data() + k);
+                poly[k] = value;
+                if(std::fabs(est - value) > 1e-3 * (1.0 + std::fabs(value)))
+                {
+                    std::cout << "***FAIL*** order " << order << " half window " << half << " epoch " << k << " " << est << " " << value << "\n";
+                    failures += 1;
+                    break;
+                }
+            }
+        }
+    }
+
+    //Arc shorter than window is left as it is
+    savitzkyGolay wide(8, 2);
+    if(wide.estimate(s, e, s + 6) != 100)
+    {
+        std::cout << "***FAIL*** short arc\n";
+        failures += 1;
+    }
+
+    if(failures != 0)
+    {
+        return 2;
+    }
+
+    std::cout << "***PASS***\n";
+    return 0;
+}